@@ -32,6 +32,8 @@
 //               0 9876 5432 10-1 2345 6789 0123 4567 8901
 //  0987.6543 2101.2345 6789.0123 4567.8901
 
+#if defined(__AVR__)
+
 static
 uint32_t
 CalcFreqMulAdd(uint32_t iFreq, uint32_t Sub, uint32_t Mul)
@@ -102,6 +104,18 @@ CalcFreqMulAdd(uint32_t iFreq, uint32_t Sub, uint32_t Mul)
 	return oFreq;
 }
 
+#else
+
+// Host version, the same bits as the assembler code: 64bits product >> 21.
+static
+uint32_t
+CalcFreqMulAdd(uint32_t iFreq, uint32_t Sub, uint32_t Mul)
+{
+	return (uint32_t)(((uint64_t)(iFreq - Sub) * Mul) >> 21);
+}
+
+#endif
+
 static uint8_t
 GetFreqBand(uint32_t freq)
 {
@@ -146,6 +160,23 @@ SetFilter(uint8_t filter)
 }
 
 
+// The frequency of the device and the filter of the band of freq.
+uint32_t
+CalcFreqDevice(uint32_t freq, uint8_t* filter)
+{
+	uint8_t band = GetFreqBand(freq);
+
+	*filter = R.Band2Filter[band];
+
+	freq = CalcFreqMulAdd(freq, R.Band2Subtract[band], R.Band2Multiply[band]);
+
+#if INCLUDE_TEMP_COMP
+	freq = TempCompFreq(freq);				// Xtal temperature correction
+#endif
+
+	return freq;
+}
+
 // Set the freq in the Si570.
 // Use the possible calculations and smooth tuning.
 // Also set the band filter based on the requested freq.
@@ -153,18 +184,24 @@ SetFilter(uint8_t filter)
 void
 SetFreq(uint32_t freq, uint8_t index)
 {
+	PROFILE_START(start);
+
 	R.Freq = freq;							// Save the asked freq
 
 #if INCLUDE_INTERRUPT						// Include the usb interrupt code
-	intrBufFreq.x.freq.data = freq;			// No freq update interrupt after set freq!
+	EventFreq = freq;						// No freq update interrupt after set freq!
 #endif
 
-	uint8_t band = GetFreqBand(freq);
+	uint8_t filter;
 
-	freq = CalcFreqMulAdd(freq, R.Band2Subtract[band], R.Band2Multiply[band]);
+	freq = CalcFreqDevice(freq, &filter);
 
-	SetFilter(R.Band2Filter[band]);
+	SetFilter(filter);
 
+	PROFILE_START(device);
 	SetFreqDevice( freq, index );
+	PROFILE_STOP(PROFILE_SET_FREQ_DEVICE, device);
+
+	PROFILE_STOP(PROFILE_SET_FREQ, start);
 }
 
@@ -0,0 +1,116 @@
+//************************************************************************
+//**
+//** Project......: Firmware USB AVR Si570 controler.
+//**
+//** Platform.....: ATtiny45
+//**
+//** Licence......: This software is freely available for non-commercial
+//**                use - i.e. for research and experimentation only!
+//**
+//** Programmer...: F.W. Krom, PE0FKO
+//**
+//** Description..: Command list, more commands in one USB transfer.
+//**                The list is send with CMD_SET_LIST (OUT) and every record
+//**                is done by the normal usbFunctionSetup / usbFunctionWrite.
+//**                The replies are read back with CMD_GET_LIST (IN).
+//**                Record: command, wValue, wIndex, length and the data.
+//**                Reply:  length and the reply data of every command.
+//**
+//** History......: Check the main.c file
+//**
+//**************************************************************************
+
+#include "main.h"
+
+#if INCLUDE_CMD_LIST
+
+#if defined (__AVR_ATmega328P__)
+#define	CMD_LIST_SIZE		32					// Max bytes of the list
+#define	CMD_LIST_REPLY		16					// Max bytes of the replies
+#else
+#define	CMD_LIST_SIZE		16					// Less RAM on the ATtiny
+#define	CMD_LIST_REPLY		8
+#endif
+#define	CMD_LIST_HEADER		6					// Record: cmd, wValue, wIndex, len
+
+static	uint8_t		CmdList[CMD_LIST_SIZE];
+static	uint8_t		CmdListLen;					// Bytes of the list, zero is too long
+static	uint8_t		CmdListPos;					// Bytes received
+static	uint8_t		CmdListReply[CMD_LIST_REPLY];
+static	uint8_t		CmdListReplyLen;
+
+// Do the commands of the list, stop on a wrong record or when the
+// reply does not fit.
+static void
+CmdListRun(void)
+{
+	uint8_t		pos = 0;
+
+	while (pos + CMD_LIST_HEADER <= CmdListLen)
+	{
+		uint8_t*	rec = &CmdList[pos];
+		uint8_t		len = rec[5];
+		uint8_t		setup[8];
+		usbMsgLen_t	n;
+
+		if (pos + CMD_LIST_HEADER + len > CmdListLen
+		||	len > 8
+		||	rec[0] == CMD_SET_LIST)
+			break;
+
+		setup[0] = USBRQ_TYPE_VENDOR | (len ? USBRQ_DIR_HOST_TO_DEVICE : USBRQ_DIR_DEVICE_TO_HOST);
+		memcpy(&setup[1], rec, 5);				// bRequest, wValue, wIndex
+		setup[6] = len;							// wLength
+		setup[7] = 0;
+
+		n = usbFunctionSetup(setup);
+		if (n == USB_NO_MSG)
+		{
+			usbFunctionWrite(&rec[CMD_LIST_HEADER], len);
+			n = 0;
+		}
+
+		if (CmdListReplyLen + 1 + n > CMD_LIST_REPLY)
+			break;
+
+		CmdListReply[CmdListReplyLen++] = n;
+		memcpy(&CmdListReply[CmdListReplyLen], usbMsgPtr, n);
+		CmdListReplyLen += n;
+
+		pos += CMD_LIST_HEADER + len;
+	}
+}
+
+void
+CmdListStart(uint16_t len)
+{
+	CmdListLen = len <= CMD_LIST_SIZE ? len : 0;
+	CmdListPos = 0;
+	CmdListReplyLen = 0;
+}
+
+// Collect the list from the 8 byte USB packets, and do it with the last one.
+uint8_t
+CmdListWrite(const uint8_t* data, uint8_t len)
+{
+	if (CmdListPos + len > CmdListLen)
+		return 0xff;							// Too long, stall
+
+	memcpy(&CmdList[CmdListPos], data, len);
+	CmdListPos += len;
+
+	if (CmdListPos < CmdListLen)
+		return 0;								// More packets to come
+
+	CmdListRun();
+	return 1;
+}
+
+uint8_t
+CmdListGetReply(void)
+{
+	usbMsgPtr = CmdListReply;
+	return CmdListReplyLen;
+}
+
+#endif
@@ -0,0 +1,194 @@
+//************************************************************************
+//**
+//** Project......: Firmware USB AVR Si570 controler.
+//**
+//** Platform.....: ATtiny45
+//**
+//** Licence......: This software is freely available for non-commercial
+//**                use - i.e. for research and experimentation only!
+//**
+//** Programmer...: F.W. Krom, PE0FKO
+//**
+//** Description..: DEVICE_AUTO, one firmware for the Si570 and the Si549.
+//**                Both device files are compiled, the functions of the
+//**                found chip are copied from flash to the vtable Device.
+//**                SetFreqDevice(), DeviceInit(), DeviceOnline() and
+//**                Si_ReadRegisters() call the chip with Device.
+//**                At boot, before the eeprom is loaded, the chip is
+//**                probed on the I2C bus. The Si549 HSDIV registers 23, 24
+//**                hold 5..2046 and reserved zero bits, the Si570 has no
+//**                registers there. The chip defaults are set in R, they
+//**                are used when the eeprom is empty.
+//**                CMD_GET_CHIP_INFO returns the found chip, CHIP_NONE if
+//**                no chip answers (the Si549 driver is used). A chip not
+//**                found is probed again by DeviceOnline(), the Softrock V9
+//**                powers the chip later.
+//**                Without DEVICE_AUTO the device file is called direct.
+//**
+//** History......: Check the main.c file
+//**
+//**************************************************************************
+
+#include "main.h"
+
+#if defined(DEVICE_AUTO)
+
+#define	SI549_HSDIV_MIN			5				// Smallest HSDIV of the Si549
+#define	SI549_HSDIV_MAX			2046			// Largest HSDIV of the Si549
+#define	SI549_REG24_RESERVED	0x88			// Reserved bits of register 24, always zero
+
+EEMEM	var_t		E;									// Variables in eeprom
+		var_t		R									// Variables in ram
+					=									// Variables in flash rom
+{		.RC_OSCCAL			= 0xFF						// CPU osc tune value
+,		.ConfigFlags		= 0							// Chip default, DeviceProbe()
+,		.FreqXtal			= 0							// Chip default, DeviceProbe()
+,		.Freq				= 0							// Chip default, DeviceProbe()
+,		.SmoothTunePPM		= 0							// Chip default, DeviceProbe()
+,		.Band2CrossOver		= { { 0 } }					// Chip default, DeviceProbe()
+,		.Band2Filter		= {	0,            1,            2,            3            }
+,		.Band2Subtract		= {	0.0 * _2(21), 0.0 * _2(21), 0.0 * _2(21), 0.0 * _2(21) }
+,		.Band2Multiply		= {	1.0 * _2(21), 1.0 * _2(21), 1.0 * _2(21), 1.0 * _2(21) }
+,		.SerialNumber		= '0'						// Default USB SerialNumber ID.
+,		.SiChipDCOMin		= 0							// Chip default, DeviceProbe()
+,		.SiChipDCOMax		= 0							// Chip default, DeviceProbe()
+,		.SiChipGrade		= 0							// Chip default, DeviceProbe()
+,		.Si570RFREQIndex	= RFREQ_DEFAULT_INDEX		// Index for the RFFREQ registers, not used in the Si549
+,		.IntrMaskIo			= IO_BIT_MASK				//
+,		.ChipCrtlData		= 0x55						// I2C address or ChipCrtlData
+,		.MinimalOutputFreqeuency	= 0					//
+,		.MaximalOutputFreqeuency	= 0					//
+,		.KeyerMode			= KEYER_OFF					// CW keyer not used
+,		.KeyerWpm			= KEYER_WPM_DEFAULT			//
+,		.KeyerWeight		= KEYER_WEIGHT_DEFAULT		//
+,		.TempCompTemp		= { 0, 0, 0, 0 }			// No temperature compensation
+,		.TempCompXtal		= { 0, 0, 0, 0 }			//
+,		.EncoderStep		= ENCODER_STEP_DEFAULT		// Encoder steps 1k, 6k, 24k, 96k
+};
+
+		chip_t		ChipInfo;							// Found chip, DeviceProbe()
+		device_t	Device;								// Driver of the found chip
+		Si_Reg_t	Si_Reg_Data;						// Si570 or Si549 register values
+		uint8_t		Chip_OffLine;						// Chip offline
+
+// Read the Si549 registers 23 (HSDIV[7:0]) and 24 (LSDIV, HSDIV[10:8]),
+// reg is zero when the read fails. Return true when a chip answers.
+static uint8_t
+DeviceReadReg23(uint16_t* reg)
+{
+	uint8_t		found;
+	uint8_t		reg23 = 0;
+	uint8_t		reg24 = 0;
+
+	I2CSendStart();
+	I2CSendByte((R.ChipCrtlData<<1)|0);	// send device address
+	found = I2CErrors == 0;
+	if (found)
+	{
+		I2CSendByte(23);				// Start at register 23
+		if (I2CErrors == 0)
+		{
+			I2CSendStart();
+			I2CSendByte((R.ChipCrtlData<<1)|1);
+			reg23 = I2CReceiveByte();
+			I2CSend0();					// 0 more bytes to follow
+			reg24 = I2CReceiveByte();
+			I2CSend1();					// 1 Last byte
+		}
+	}
+	I2CSendStop();
+
+	*reg = I2CErrors ? 0 : (reg24 << 8) | reg23;
+	return found;
+}
+
+// Find the chip and load its driver, return true when a chip answers.
+static uint8_t
+DeviceFind(void)
+{
+	const device_t*	driver = &DeviceSi549;		// Also used when no chip answers
+	uint8_t			found = false;
+	uint16_t		reg;
+	uint16_t		hsdiv;
+
+	if ((I2C_PIN & _BV(BIT_SCL)) != 0)			// SCL high, the chip has power (Softrock V9)
+	{
+		found = DeviceReadReg23(&reg);
+		hsdiv = reg & 0x07FF;
+		if (found
+		&&  ((reg & (SI549_REG24_RESERVED << 8)) != 0 || hsdiv < SI549_HSDIV_MIN || hsdiv > SI549_HSDIV_MAX))
+			driver = &DeviceSi570;
+	}
+
+	memcpy_P(&Device, driver, sizeof(Device));
+
+	ChipInfo = Device.chip;
+	if (!found)
+		ChipInfo.chipID = CHIP_NONE;
+
+	return found;
+}
+
+// The chip defaults of the driver in R.
+static void
+DeviceDefaults(void)
+{
+	R.ConfigFlags		= Device.ConfigFlags;
+	R.FreqXtal			= Device.chip.chipXTal;
+	R.Freq				= Device.Freq;
+	R.SmoothTunePPM		= Device.SmoothTunePPM;
+	memcpy(R.Band2CrossOver, Device.Band2CrossOver, sizeof(R.Band2CrossOver));
+	R.SiChipGrade		= Device.chip.chipGrade;
+	R.SiChipDCOMin		= Device.DCOMin;
+	R.SiChipDCOMax		= Device.DCOMax;
+}
+
+// Find the chip and load its driver, called before the eeprom is loaded.
+// The I2C address is the one in the eeprom, when the eeprom is used.
+// The chip defaults are set in R, the eeprom values replace them when
+// the eeprom is used.
+void
+DeviceProbe(void)
+{
+	uint8_t		addr = EepromReadByte(&R.ChipCrtlData);
+
+	if (addr != 0xFF)
+		R.ChipCrtlData = addr;
+
+	DeviceFind();
+	DeviceDefaults();
+}
+
+// DeviceOnline() of the found driver. A chip not found at boot is probed
+// again, a empty eeprom at boot gets the defaults of the found chip.
+void
+DeviceAutoOnline(void)
+{
+	if (ChipInfo.chipID == CHIP_NONE && (I2C_PIN & _BV(BIT_SCL)) != 0)
+	{
+		I2CQueueFlush();
+		if (DeviceFind())
+		{
+			if (EepromGetState() == EEPROM_DEFAULTS)
+			{
+				DeviceDefaults();
+				EepromWrite(&R.ConfigFlags, sizeof(R.ConfigFlags));
+				EepromWrite(&R.FreqXtal, sizeof(R.FreqXtal));
+				EepromWrite(&R.SmoothTunePPM, sizeof(R.SmoothTunePPM));
+				EepromWrite(&R.Band2CrossOver, sizeof(R.Band2CrossOver));
+				EepromWrite(&R.SiChipGrade, sizeof(R.SiChipGrade));
+				EepromWrite(&R.SiChipDCOMin, sizeof(R.SiChipDCOMin));
+				EepromWrite(&R.SiChipDCOMax, sizeof(R.SiChipDCOMax));
+				EepromSetStartup(R.Freq);
+			}
+
+			ImageCacheFlush();					// Registers of the other driver
+			Device.Init();
+			HopRecalc();
+		}
+	}
+
+	Device.Online();
+}
+
+#endif
@@ -23,6 +23,40 @@
 
 #if defined(DEVICE_SI549)
 
+#define Chip_Grade_Default		CHIP_GRADE_A			// Use the grade A chip by default
+#define Chip_Freq_Xtal			0x98999999				// Si549 Chip crystal frequency, 152.6MHz * [8.24](32)
+#define	Chip_SmoothTunePPM		950						// SmoothTunePPM Si549
+#define	Chip_DCO_Min			10800					// min VCO frequency 10.800,000000 MHz
+#define	Chip_DCO_Max			12511					// max VCO frequency 12.511,886114 MHz
+
+#define CHIP_MinimalOutputFreqeuency		((uint32_t)(   0.2 * _2(21)))
+#define	CHIP_MaximalOutputFreqeuency_A		((uint32_t)(1500.0 * _2(21)))
+#define	CHIP_MaximalOutputFreqeuency_B		((uint32_t)( 800.0 * _2(21)))
+#define	CHIP_MaximalOutputFreqeuency_C		((uint32_t)( 325.0 * _2(21)))
+
+#if defined(DEVICE_AUTO)								// Only called by the DeviceSi549 driver
+#undef	SetFreqDevice
+#undef	DeviceInit
+#undef	DeviceOnline
+#undef	Si_ReadRegisters
+#undef	DeviceCalcImage
+#undef	DeviceSetImage
+#undef	DeviceSmoothTune
+#define	SetFreqDevice			Si549SetFreqDevice
+#define	DeviceInit				Si549DeviceInit
+#define	DeviceOnline			Si549DeviceOnline
+#define	Si_ReadRegisters		Si549ReadRegisters
+#define	DeviceCalcImage			Si549CalcImage
+#define	DeviceSetImage			Si549DeviceSetImage
+#define	DeviceSmoothTune		Si549SmoothTune
+static	void		SetFreqDevice(uint32_t freq, uint8_t index);
+static	void		DeviceInit(void);
+static	void		DeviceOnline(void);
+static	uint8_t		Si_ReadRegisters(uint8_t index);
+static	uint8_t		DeviceCalcImage(uint32_t freq, image_t* image);
+static	void		DeviceSetImage(const image_t* image);
+static	uint8_t		DeviceSmoothTune(uint32_t freq);
+#else
 EEMEM	var_t		E;											// Variables in eeprom
 		var_t		R											// Variables in ram
 					=											// Variables in flash rom
@@ -30,7 +64,7 @@ EEMEM	var_t		E;											// Variables in eeprom
 ,		.ConfigFlags				= 0							// No ABPF selected
 ,		.FreqXtal					= Chip_Freq_Xtal			// crystal frequency[MHz], 152.6MHz, [8.24](32), calibrated
 ,		.Freq						= 0x0C800000				// Running startup frequency, 100.0MHz, [11.21](32)
-,		.SmoothTunePPM				= 950						// SmoothTunePPM Si549
+,		.SmoothTunePPM				= Chip_SmoothTunePPM		// SmoothTunePPM Si549
 ,		.Band2CrossOver[0]			= {  4.0 * 4.0 * _2(5) }	// Default filter cross over
 ,		.Band2CrossOver[1]			= {  8.0 * 4.0 * _2(5) }	// frequnecy for softrock V9
 ,		.Band2CrossOver[2]			= { 16.0 * 4.0 * _2(5) }	// BPF. Four value array.
@@ -39,14 +73,20 @@ EEMEM	var_t		E;											// Variables in eeprom
 ,		.Band2Subtract				= {	0.0 * _2(21), 0.0 * _2(21), 0.0 * _2(21), 0.0 * _2(21) }
 ,		.Band2Multiply				= {	1.0 * _2(21), 1.0 * _2(21), 1.0 * _2(21), 1.0 * _2(21) }
 ,		.SerialNumber				= '0'						// Default USB SerialNumber ID.
-,		.SiChipDCOMin				= 10800						// min VCO frequency 10.800,000000 MHz
-,		.SiChipDCOMax				= 12511						// max VCO frequency 12.511,886114 MHz
+,		.SiChipDCOMin				= Chip_DCO_Min				// min VCO frequency 10.800,000000 MHz
+,		.SiChipDCOMax				= Chip_DCO_Max				// max VCO frequency 12.511,886114 MHz
 ,		.SiChipGrade				= Chip_Grade_Default		// Si570 chip grade A default (save)
 ,		.Si570RFREQIndex			= 23						// Not used in the Si549
 ,		.IntrMaskIo					= IO_BIT_MASK				//
 ,		.ChipCrtlData				= 0x55						// I2C address or ChipCrtlData
 ,		.MinimalOutputFreqeuency	= 0							//
 ,		.MaximalOutputFreqeuency	= 0							//
+,		.KeyerMode					= KEYER_OFF					// CW keyer not used
+,		.KeyerWpm					= KEYER_WPM_DEFAULT			//
+,		.KeyerWeight				= KEYER_WEIGHT_DEFAULT		//
+,		.TempCompTemp				= { 0, 0, 0, 0 }			// No temperature compensation
+,		.TempCompXtal				= { 0, 0, 0, 0 }			//
+,		.EncoderStep				= ENCODER_STEP_DEFAULT		// Encoder steps 1k, 6k, 24k, 96k
 };
 
 chip_t	ChipInfo = 
@@ -57,10 +97,16 @@ chip_t	ChipInfo =
 
 		Si_Reg_t	Si_Reg_Data;					// Si549 register values
 		uint8_t		Chip_OffLine;					// Si549 offline
+#endif
+
 static	uint32_t	NonimalFreq;					// The smooth tune center frequency
+static	uint32_t	NonimalRecip;					// 15625 * 2^(20+NonimalShift) / NonimalFreq
+static	uint8_t		NonimalShift;					// Shift of the reciprocal, 16..29
+		uint8_t		Si549Page = SI549_PAGE_UNKNOWN;	// Page register 255 of the chip
 
 static	void		Si549WriteNewFrequencyRegisters(void);
 static	void		Si549WritePPMRegisters(void);
+static	void		Si549SetPage0(void);
 
 #include "mul_div.h"
 
@@ -120,6 +166,30 @@ CalculateFrequencyRegisters(uint32_t freq)	// [11.21]
 	Si_Reg_Data.FBDIV_42_40		= vco.l1.w0.b1;
 }
 
+// Set the smooth tune center frequency and the reciprocal of it, the only
+// divide for all the small changes around this center.
+//	Recip = 15625 * 2^(20+S) / F1	=> [14.0] << 20+S / [11.21]	=> [.32]
+//	S is the bit length of F1 - 3, the reciprocal is 31 or 32 bits.
+static void
+Si549SetCenter(uint32_t freq)
+{
+	uint32_t	f = freq;
+	uint8_t		shift = 29;
+
+	NonimalFreq = freq;
+	if (freq == 0)
+		return;
+
+	while (!(f & 0x80000000))
+	{
+		f <<= 1;
+		shift--;
+	}
+
+	NonimalShift = shift;
+	NonimalRecip = udiv_48_48_32_R(15625, freq, 20 + shift);
+}
+
 static uint8_t
 Si549SmallChange(uint32_t frequency)
 {
@@ -147,6 +217,9 @@ Si549SmallChange(uint32_t frequency)
  *	
  *	Direct calc: no ppm check direct possible?
  *	PPMreg = 1.000.000 * dF / F1 / 0.0001164	=> 8591065292 * dF / F1	=> [34.0] * [1.21] / [11.21]	=> [35.21](56) / [11.21](32) => [24.0]
+ *
+ *	The divide by F1 is the same for all steps around one center, Si549SetCenter()
+ *	calculates the reciprocal once. The PPM is then only multiplies and a shift.
  */
 
 	if (NonimalFreq == 0)						// Freq chip unknow for now,
@@ -164,13 +237,11 @@ Si549SmallChange(uint32_t frequency)
 	if ( dF.l0.w1.w & 0xFFC0 )					// If dF >= 2MHz
 			return false;						//   then exit
 
-	// Multiply dF by 1.000.000 / 2^6 (0xF4240 = 1.000.000, 0x3D09 = 15.625)
-	// PPM = [1.21] * [14.0] => [15.21](36)
-	dF.ll = umul_48_32_16(dF.l0.dw, 15625);
-
-	//	PPM = dF / F1 * 2^6
-	//	[15.21](36) / [11.21]	=> [4.0]	R6+14 [10.14](24)
-	dF.ll = udiv_48_48_32_R(dF.ll, NonimalFreq, 6 + 14);
+	//	PPM = dF * 15625 / F1 * 2^20 => dF * Recip >> S
+	//	[1.21](22) * [.32] => [54] >> S	=> [10.14](24)
+	dF.ll = (umul_48_32_16(dF.l0.dw, NonimalRecip >> 16) << 16)
+		  + umul_48_32_16(dF.l0.dw, (uint16_t)NonimalRecip);
+	dF.ll >>= NonimalShift;
 
 	// Check if the PPM value is below 950+1 (+1 we don't check the fraction)
 	if ((dF.ll >> 14) >= R.SmoothTunePPM)		// [10.14](24)
@@ -207,7 +278,14 @@ SetFreqDevice(uint32_t freq, uint8_t dummy)
 		}
 		else
 		{
-			NonimalFreq = freq;
+#if INCLUDE_IMAGE_CACHE
+			image_t		image;
+
+			if (!ImageCacheCalc(freq, &image))
+				return;
+			DeviceSetImage(&image);
+#else
+			Si549SetCenter(freq);
 
 			CalculateFrequencyRegisters( freq );
 
@@ -222,10 +300,109 @@ SetFreqDevice(uint32_t freq, uint8_t dummy)
 				Si_Reg_Data.ADPLL_DELTA_M_23_16 = 0;
 				Si549WritePPMRegisters( );
 			}
+#endif
 		}
 	}
 }
 
+static void
+Si549GetImage(image_t* image)
+{
+	image->reg		= Si_Reg_Data;
+	image->center	= NonimalFreq;
+	image->recip	= NonimalRecip;
+	image->shift	= NonimalShift;
+}
+
+static void
+Si549SetImage(const image_t* image)
+{
+	Si_Reg_Data		= image->reg;
+	NonimalFreq		= image->center;
+	NonimalRecip	= image->recip;
+	NonimalShift	= image->shift;
+}
+
+// Calculate the registers of a large change to freq, the running
+// frequency is not changed.
+uint8_t
+DeviceCalcImage(uint32_t freq, image_t* image)
+{
+	image_t		run;
+
+	if ((R.SiChipGrade != CHIP_GRADE_D)
+	&&  ((freq < R.MinimalOutputFreqeuency) || (freq > R.MaximalOutputFreqeuency)) )
+		return false;
+
+	Si549GetImage(&run);
+
+	Si549SetCenter(freq);
+	CalculateFrequencyRegisters(freq);
+	Si_Reg_Data.ADPLL_DELTA_M_7_0	= 0;
+	Si_Reg_Data.ADPLL_DELTA_M_15_8	= 0;
+	Si_Reg_Data.ADPLL_DELTA_M_23_16	= 0;
+	Si549GetImage(image);
+
+	Si549SetImage(&run);
+	return true;
+}
+
+// Write the image with a large change, it is the new smooth tune center.
+void
+DeviceSetImage(const image_t* image)
+{
+	uint8_t		ppm = Si_Reg_Data.ADPLL_DELTA_M_7_0
+					| Si_Reg_Data.ADPLL_DELTA_M_15_8
+					| Si_Reg_Data.ADPLL_DELTA_M_23_16;
+
+	Si549SetImage(image);
+	Si549WriteNewFrequencyRegisters();
+
+	if (ppm != 0)								// Smooth tune offset not zero
+		Si549WritePPMRegisters();
+}
+
+// Set freq with a small change, return false when it is not within the
+// smooth tune window of the running center.
+uint8_t
+DeviceSmoothTune(uint32_t freq)
+{
+	if ((R.SmoothTunePPM == 0) || !Si549SmallChange(freq))
+		return false;
+
+	Si549WritePPMRegisters();
+	return true;
+}
+
+#if INCLUDE_PROFILE
+// CPU cycles of one CalculateFrequencyRegisters() and one Si549SmallChange()
+// call, the mean of BENCH_CALLS calls in a sweep from freq. The smooth tune
+// center is freq. The running registers are not changed.
+void
+Si549Bench(uint16_t* cycles, uint32_t freq, uint32_t step)
+{
+	image_t		run;
+	uint32_t	f;
+	uint16_t	t;
+	uint8_t		i;
+
+	Si549GetImage(&run);
+	Si549SetCenter(freq);
+
+	t = TimerGetCounts();
+	for (i = 0, f = freq; i < BENCH_CALLS; ++i, f += step)
+		CalculateFrequencyRegisters(f);
+	cycles[0] = (TimerGetCounts() - t) * (256 / BENCH_CALLS);
+
+	t = TimerGetCounts();
+	for (i = 0, f = freq; i < BENCH_CALLS; ++i, f += step)
+		Si549SmallChange(f);
+	cycles[1] = (TimerGetCounts() - t) * (256 / BENCH_CALLS);
+
+	Si549SetImage(&run);
+}
+#endif
+
 void
 DeviceInit(void)
 {
@@ -255,7 +432,9 @@ DeviceOnline(void)
 		if (Chip_OffLine)
 		{
 			NonimalFreq = 0L;					// Next SetFreq call no smooth-tune
+			Si549Page = SI549_PAGE_UNKNOWN;		//   and a page write
 			SetFreq(R.Freq, 0);
+			I2CQueueFlush();
 
 			Chip_OffLine = I2CErrors;
 		}
@@ -279,42 +458,33 @@ Si_CmdStart(uint8_t cmd)
 	return false;
 }
 
-void
-Si_CmdReg(uint8_t reg, uint8_t data)
+// The page register is only written when the chip is not on page 0,
+// the page is unknown after a power up, a failed I2C write (I2CQueue.c)
+// and a debug write.
+static void
+Si549SetPage0(void)
 {
-	if (Si_CmdStart(reg))
+	if (Si549Page != 0)
 	{
-		I2CSendByte(data);
+		Si549Page = 0;								// Before the write, a failed write sets it unknown
+		Si_CmdReg(255, 0x00);						// CMD=255, Set page register to point to page 0
 	}
-	I2CSendStop();
 }
 
 static void
 Si549WriteNewFrequencyRegisters(void)
 {
-	Si_CmdReg(255, 0x00);							// CMD=255, Set page register to point to page 0
-	if (I2CErrors == 0)
+	Si549SetPage0();
+	if (I2C_WRITE_OK)
 	{
 		Si_CmdReg(69, 0x00);						// CMD=69, Disable FCAL overwrite
 		Si_CmdReg(17, 0x00);						// CMD=17, Synchronously disable output
 
-		if (Si_CmdStart(23))						// CMD=23 & 24
-		{
-			I2CSendByte( Si_Reg_Data.HSDIV_7_0 );	
-			I2CSendByte( Si_Reg_Data.LSDIV_2_0_HSDIV_10_8 );
-		}
-		I2CSendStop();
+		// CMD=23 & 24, HSDIV_7_0, LSDIV_2_0_HSDIV_10_8
+		I2CWriteRegs(23, &Si_Reg_Data.HSDIV_7_0, 2);
 
-		if (Si_CmdStart(26))						// CMD=26, 27 28, 29, 30, 31
-		{
-			I2CSendByte( Si_Reg_Data.FBDIV_7_0 );	// FBFRAC.w0.b0
-			I2CSendByte( Si_Reg_Data.FBDIV_15_8 );	// FBFRAC.w0.b1
-			I2CSendByte( Si_Reg_Data.FBDIV_23_16 );	// FBFRAC.w1.b0
-			I2CSendByte( Si_Reg_Data.FBDIV_31_24 );	// FBFRAC.w1.b1
-			I2CSendByte( Si_Reg_Data.FBDIV_39_32 );	// FBINT.b0
-			I2CSendByte( Si_Reg_Data.FBDIV_42_40 );	// FBINT.b1
-		}
-		I2CSendStop();
+		// CMD=26, 27 28, 29, 30, 31, FBFRAC[31:0], FBINT[10:0]
+		I2CWriteRegs(26, &Si_Reg_Data.FBDIV_7_0, 6);
 		
 		Si_CmdReg( 7, 0x08);						// CMD=7, Start FCAL
 		Si_CmdReg(17, 0x01);						// CMD=17, Synchronously enable output
@@ -324,13 +494,8 @@ Si549WriteNewFrequencyRegisters(void)
 static void
 Si549WritePPMRegisters(void)
 {
-	if (Si_CmdStart(231))			// CMD=231, 232, 323
-	{
-		I2CSendByte( Si_Reg_Data.ADPLL_DELTA_M_7_0 );
-		I2CSendByte( Si_Reg_Data.ADPLL_DELTA_M_15_8 );
-		I2CSendByte( Si_Reg_Data.ADPLL_DELTA_M_23_16 );
-	}
-	I2CSendStop();
+	// CMD=231, 232, 323
+	I2CWriteRegs(231, &Si_Reg_Data.ADPLL_DELTA_M_7_0, 3);
 }
 
 // read all registers in one block to Si_Reg_Data
@@ -339,6 +504,8 @@ Si_ReadRegisters(uint8_t index)
 {
 	uint8_t i;
 
+	I2CQueueFlush();								// First the pending writes
+
 	if (Si_CmdStart(23))							// Start at register 23
 	{
 		I2CSendStart();
@@ -379,5 +546,23 @@ Si_ReadRegisters(uint8_t index)
 	return I2CErrors ? 0 : 11;
 }
 
+#if defined(DEVICE_AUTO)
+const device_t DeviceSi549 PROGMEM =
+{	.SetFreq				= SetFreqDevice
+,	.Init					= DeviceInit
+,	.Online					= DeviceOnline
+,	.ReadRegisters			= Si_ReadRegisters
+,	.CalcImage				= DeviceCalcImage
+,	.SetImage				= DeviceSetImage
+,	.SmoothTune				= DeviceSmoothTune
+,	.chip					= { CHIP_SI549, Chip_Grade_Default, Chip_Freq_Xtal }
+,	.ConfigFlags			= 0
+,	.Freq					= 0x0C800000
+,	.Band2CrossOver			= { { 4.0 * 4.0 * _2(5) }, { 8.0 * 4.0 * _2(5) }, { 16.0 * 4.0 * _2(5) }, { 0 } }
+,	.SmoothTunePPM			= Chip_SmoothTunePPM
+,	.DCOMin					= Chip_DCO_Min
+,	.DCOMax					= Chip_DCO_Max
+};
+#endif
+
 #endif
- 
\ No newline at end of file
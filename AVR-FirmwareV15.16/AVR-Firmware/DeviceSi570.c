@@ -26,6 +26,42 @@
 
 #if defined(DEVICE_SI570)
 
+#define Chip_Grade_Default		CHIP_GRADE_C			// Use the grade C chip by default
+#define Chip_Freq_Xtal			0x7248F5C2				// crystal frequency[MHz] [8.24] 114.285MHz
+#define	Chip_SmoothTunePPM		3500					// SmoothTunePPM
+#define	Chip_DCO_Min			4850					// min VCO frequency 4850 MHz
+#define	Chip_DCO_Max			5670					// max VCO frequency 5670 MHz
+
+#define CHIP_MinimalOutputFreqeuency		((uint32_t)(  10.0 * _2(21)))
+#define	CHIP_MaximalOutputFreqeuency_A		((uint32_t)(1417.5 * _2(21)))
+#define	CHIP_MaximalOutputFreqeuency_B		((uint32_t)( 810.0 * _2(21)))
+#define	CHIP_MaximalOutputFreqeuency_C		((uint32_t)( 280.0 * _2(21)))
+#define	NEW_FREQ_POLLS			10						// Reads of the NewFreq bit after a large change,
+#define	NEW_FREQ_POLL_US		100						//   and the time between them
+
+#if defined(DEVICE_AUTO)								// Only called by the DeviceSi570 driver
+#undef	SetFreqDevice
+#undef	DeviceInit
+#undef	DeviceOnline
+#undef	Si_ReadRegisters
+#undef	DeviceCalcImage
+#undef	DeviceSetImage
+#undef	DeviceSmoothTune
+#define	SetFreqDevice			Si570SetFreqDevice
+#define	DeviceInit				Si570DeviceInit
+#define	DeviceOnline			Si570DeviceOnline
+#define	Si_ReadRegisters		Si570ReadRegisters
+#define	DeviceCalcImage			Si570CalcImage
+#define	DeviceSetImage			Si570DeviceSetImage
+#define	DeviceSmoothTune		Si570SmoothTune
+static	void		SetFreqDevice(uint32_t freq, uint8_t index);
+static	void		DeviceInit(void);
+static	void		DeviceOnline(void);
+static	uint8_t		Si_ReadRegisters(uint8_t index);
+static	uint8_t		DeviceCalcImage(uint32_t freq, image_t* image);
+static	void		DeviceSetImage(const image_t* image);
+static	uint8_t		DeviceSmoothTune(uint32_t freq);
+#else
 EEMEM	var_t		E;									// Variables in eeprom
 		var_t		R									// Variables in ram
 					=									// Variables in flash rom
@@ -33,7 +69,7 @@ EEMEM	var_t		E;									// Variables in eeprom
 ,		.ConfigFlags		= CONFIG_ABPF				// Only ABPF selected
 ,		.FreqXtal			= Chip_Freq_Xtal			// crystal frequency[MHz] [8.24] 114.285MHz 
 ,		.Freq				= 0x03866666				// Running frequency[MHz] [11.21] 28.2MHz / 4 = 7.050MHz
-,		.SmoothTunePPM		= 3500						// SmoothTunePPM
+,		.SmoothTunePPM		= Chip_SmoothTunePPM		// SmoothTunePPM
 ,		.Band2CrossOver[0]	= {  4.0 * 4.0 * _2(5) }	// Default filter cross over
 ,		.Band2CrossOver[1]	= {  8.0 * 4.0 * _2(5) }	// frequnecy for softrock V9
 ,		.Band2CrossOver[2]	= { 16.0 * 4.0 * _2(5) }	// BPF. Four value array.
@@ -42,14 +78,20 @@ EEMEM	var_t		E;									// Variables in eeprom
 ,		.Band2Subtract		= {	0.0 * _2(21), 0.0 * _2(21), 0.0 * _2(21), 0.0 * _2(21) }
 ,		.Band2Multiply		= {	1.0 * _2(21), 1.0 * _2(21), 1.0 * _2(21), 1.0 * _2(21) }
 ,		.SerialNumber		= '0'						// Default USB SerialNumber ID.
-,		.SiChipDCOMin		= 4850						// min VCO frequency 4850 MHz
-,		.SiChipDCOMax		= 5670						// max VCO frequency 5670 MHz
+,		.SiChipDCOMin		= Chip_DCO_Min				// min VCO frequency 4850 MHz
+,		.SiChipDCOMax		= Chip_DCO_Max				// max VCO frequency 5670 MHz
 ,		.SiChipGrade		= Chip_Grade_Default				// Si570 chip grade C default (save)
 ,		.Si570RFREQIndex	= RFREQ_DEFAULT_INDEX		// Index for the RFFREQ registers
 ,		.IntrMaskIo			= IO_BIT_MASK				//
 ,		.ChipCrtlData		= 0x55						// I2C address or ChipCrtlData
 ,		.MinimalOutputFreqeuency	= 0					// 
 ,		.MaximalOutputFreqeuency	= 0					// 
+,		.KeyerMode			= KEYER_OFF					// CW keyer not used
+,		.KeyerWpm			= KEYER_WPM_DEFAULT			//
+,		.KeyerWeight		= KEYER_WEIGHT_DEFAULT		//
+,		.TempCompTemp		= { 0, 0, 0, 0 }			// No temperature compensation
+,		.TempCompXtal		= { 0, 0, 0, 0 }			//
+,		.EncoderStep		= ENCODER_STEP_DEFAULT		// Encoder steps 1k, 6k, 24k, 96k
 };
 
 chip_t	ChipInfo = 
@@ -60,22 +102,35 @@ chip_t	ChipInfo =
 
 		Si_Reg_t	Si_Reg_Data;						// Si570 register values
 		uint8_t		Chip_OffLine;						// Si570 offline
+#endif
+
 static	uint32_t	FreqSmoothTune;						// The smooth tune center frequency
+static	uint32_t	FreqSmoothBound;					// Max delta of the smooth tune [11.21]
+static	uint32_t	FreqBoundCenter;					// Center of FreqSmoothBound
+static	uint16_t	FreqBoundPPM;						// SmoothTunePPM of FreqSmoothBound
+static	uint32_t	FreqLast;							// Last asked frequency
+static	uint32_t	FreqStep;							// Last step of the asked frequency
+static	int8_t		FreqDir;							// Direction of the last step, 1, -1 or 0
+static	uint8_t		FreqRun;							// Two steps in the same direction
 static	uint16_t	Si570_N;							// Total division (N1 * HS_DIV)
 static	uint8_t		Si570_N1;							// The slow divider
 static	uint8_t		Si570_HS_DIV;						// The high speed divider
 
 static	void		Si570WriteSmallChange(void);
 static	void		Si570WriteLargeChange(void);
+static	void		Si570WaitNewFreq(void);
 
 #include "mul_div.h"
 
 
+#if !INCLUDE_SI570_DIV_TABLE || defined(SI570_DIV_TABLE_GEN)
+
 // Cost: 140us
 // This function only works for the "C" & "B" grade of the Si570 chip.
 // It will not check the frequency gaps for the "A" grade chip!!!
+// N0 is the total division needed, it is always one to low.
 static uint8_t
-Si570CalcDivider(uint32_t freq)
+Si570SearchDivider(uint16_t N0)
 {
 	// Register finding the lowest DCO frequenty
 	uint8_t		xHS_DIV;
@@ -86,15 +141,6 @@ Si570CalcDivider(uint32_t freq)
 	uint8_t		sHS_DIV	= 0;
 	uint8_t		sN1		= 0;
 	uint16_t	sN		= 11*128;		// Total dividing
-	uint16_t	N0;						// Total divider needed (N1 * HS_DIV)
-	sint32_t	Freq;
-
-	Freq.dw = freq;
-
-	// Find the total division needed.
-	// It is always one to low (not in the case reminder is zero, reminder not used here).
-	// 16.0 bits = 13.3 bits / ( 11.5 bits >> 2)
-	N0 = (R.SiChipDCOMin * (uint16_t)(_2(3))) / (Freq.w1.w >> 2);
 
 	for(xHS_DIV = 11; xHS_DIV > 3; --xHS_DIV)
 	{
@@ -185,6 +231,93 @@ Si570CalcDivider(uint32_t freq)
 	return true;
 }
 
+#endif
+
+#if INCLUDE_SI570_DIV_TABLE
+
+#include "Si570DivTable.h"
+
+// The same result as Si570SearchDivider(), from the flash table build by
+// Si570DivTableGen.c. Only the N0 below SI570_DIV_SMALL_N0 depends on the
+// chip grade, above it there are runs of N0 with the same HS_DIV and the
+// N1 follows from N0 and HS_DIV.
+static uint8_t
+Si570TableDivider(uint16_t N0)
+{
+	uint8_t		xHS_DIV;
+	sint16_t	xN1;
+
+	if (N0 < SI570_DIV_SMALL_N0)
+	{
+		uint8_t grade = R.SiChipGrade - CHIP_GRADE_A;
+		if (grade > CHIP_GRADE_D - CHIP_GRADE_A)	// Unknown grade, no divider restrictions
+			grade = 0;
+
+		xHS_DIV = pgm_read_byte(&Si570DivSmall[grade][N0]);
+		xN1.w   = xHS_DIV & 0x0F;
+		xHS_DIV >>= 4;
+	}
+	else
+	{
+		// Find the last run that starts at or below N0
+		uint16_t	run;
+		uint16_t	lo = 0;
+		uint16_t	hi = SI570_DIV_RUNS - 1;
+
+		while (lo < hi)
+		{
+			uint16_t mid = (lo + hi + 1) >> 1;
+			if ((pgm_read_word(&Si570DivRuns[mid]) & SI570_DIV_RUN_N0) <= N0)
+				lo = mid;
+			else
+				hi = mid - 1;
+		}
+
+		run = pgm_read_word(&Si570DivRuns[lo]);
+		xHS_DIV = run >> SI570_DIV_RUN_HS_SHIFT;
+		if (xHS_DIV == 0)
+			return false;
+
+		xN1.w = N0 / xHS_DIV + 1;
+		if (xN1.b0 != 1 && (xN1.b0 & 1) == 1)
+			xN1.b0 += 1;
+	}
+
+	if (xHS_DIV == 0)
+		return false;
+
+	Si570_N      = xHS_DIV * xN1.b0;
+	Si570_N1     = xN1.b0;
+	Si570_HS_DIV = xHS_DIV;
+
+	return true;
+}
+
+#endif
+
+static uint8_t
+Si570CalcDivider(uint32_t freq)
+{
+	uint16_t	N0;						// Total divider needed (N1 * HS_DIV)
+	sint32_t	Freq;
+
+	Freq.dw = freq;
+
+	if ((Freq.w1.w >> 2) == 0)			// Below 0.125MHz, no divider possible
+		return false;
+
+	// Find the total division needed.
+	// It is always one to low (not in the case reminder is zero, reminder not used here).
+	// 16.0 bits = 13.3 bits / ( 11.5 bits >> 2)
+	N0 = (R.SiChipDCOMin * (uint16_t)(_2(3))) / (Freq.w1.w >> 2);
+
+#if INCLUDE_SI570_DIV_TABLE
+	return Si570TableDivider(N0);
+#else
+	return Si570SearchDivider(N0);
+#endif
+}
+
 // frequency [MHz] * 2^21
 static uint8_t
 Si570CalcRFREQ(uint32_t freq, uint8_t index)
@@ -234,74 +367,113 @@ Si570CalcRFREQ(uint32_t freq, uint8_t index)
 	return 1;
 }
 
-#if 1
-uint64_t	A0;
-uint64_t	A1;
-uint64_t	A2;
-long double	D1;
-uint32_t	_freq;
-uint64_t	_dF1;
-uint64_t	_dF2;
-uint32_t		_B0,_B1;
-#endif
-
+// Return true if the output changes not more than R.SmoothTunePPM
+// from the smooth tune center. The bound is the exact
+// center * SmoothTunePPM / 1000000 [11.21], the floor of it is exact for
+// the compare with a [11.21] difference. Calculated once for a new center
+// or a new SmoothTunePPM (USB command).
 static uint8_t
 Si570SmallChange(uint32_t frequency)
 {
-	sint64_t	dF;
-//	uint32_t	delta_F, 
-	uint32_t	delta_F_MAX;
+	uint32_t	dF;
+
+	if (FreqBoundCenter != FreqSmoothTune || FreqBoundPPM != R.SmoothTunePPM)
+	{
+		FreqBoundCenter	= FreqSmoothTune;
+		FreqBoundPPM	= R.SmoothTunePPM;
+		FreqSmoothBound	= udiv_48_48_32_R(umul_48_32_16(FreqBoundCenter, FreqBoundPPM), 1000000, 0);
+	}
 
-/*	R.SmoothTunePPM: 0x0DAC
- *	frequency	FreqSmoothTune	dF.ll				*15					delta_F_MAX
- *	0x0c800000	0x00000000		0x000000000C800000	0x00000000BB800000	0x00000000	
- *	0x0c8a8f5c	0x0c800000		0x00000000000A8F5C	0x009e6664			0x00aae600		0x009e6664 <= 0x00aae600
-*/
+	// Delta_F (MHz) = |current_Frequency - FreqSmoothTune|  -> [11.21]
+	dF = frequency - FreqSmoothTune;
+	if (frequency < FreqSmoothTune)
+		dF = FreqSmoothTune - frequency;
 
-//	sint32_t previous_Frequency;
+	return dF <= FreqSmoothBound;
+}
 
-	// Get previous_Frequency   -> [11.21]
-//	previous_Frequency.dw = FreqSmoothTune;
 
-	// Delta_F (MHz) = |current_Frequency - FreqSmoothTune|  -> [11.21]
-	dF.ll = (uint64_t)frequency - FreqSmoothTune;
-	_dF1 = dF.ll;
-
-	if (dF.l1.w1.b1 & 0x80)				// Check for negative value
-		dF.ll = 0 - dF.ll;				// Make it always positive
-
-//	delta_F = frequency - FreqSmoothTune;
-//	if (delta_F >= _2(31)) 
-//		delta_F = 0 - delta_F;
-
-	// Delta_F (Hz) = (Delta_F (MHz) * 1_000_000) >> 16 not possible, overflow
-	// replaced by:
-	// Delta_F (Hz) = (Delta_F (MHz) * (1_000_000 >> 16)
-	//              = Delta_F (MHz) * 15  (instead of 15.258xxxx)
-	// Error        = (15 - 15.258) / 15.258 = 0.0169 < 1.7%
-
-//	delta_F = delta_F * 15;          // [27.5] = [11.21] * [16.0]
-	dF.l0.dw = dF.l0.dw * 15;          // [27.5] = [11.21] * [16.0]
-	_dF2 = dF.ll;
-
-	// Compute delta_F_MAX (Hz)= previous_Frequency(MHz) * 3500 ppm
-//	delta_F_MAX = (uint32_t)previous_Frequency.w1.w * R.SmoothTunePPM;
-	delta_F_MAX = (uint32_t)((sint32_t)FreqSmoothTune).w1.w * R.SmoothTunePPM;
-	//   [27.5] =                          [11.5] * [16.0]
-	_B0 = delta_F_MAX;
-	_B1 = dF.l0.dw;
-	
-	// return TRUE if output changes less than 3500 ppm from the previous_Frequency
-//	return (delta_F <= delta_F_MAX) ? true : false;
-	return (dF.l0.dw <= delta_F_MAX) ? true : false;
+// Keep the direction and the step of the asked frequencies.
+static void
+Si570TrackTuning(uint32_t freq)
+{
+	int8_t		dir = 0;
+
+	if (freq > FreqLast)
+	{
+		dir = 1;
+		FreqStep = freq - FreqLast;
+	}
+	if (freq < FreqLast)
+	{
+		dir = -1;
+		FreqStep = FreqLast - freq;
+	}
+
+	FreqRun  = dir != 0 && dir == FreqDir;		// Two steps in the same direction
+	FreqDir  = dir;
+	FreqLast = freq;
+}
+
+// Center of the large change to freq. In a tuning run (sweep, encoder) the
+// center is ahead of freq in the tuning direction, freq is one step from the
+// window edge behind it. The next steps stay in the window about twice as
+// long. Jumps and steps larger than half the window are centered on freq.
+static uint32_t
+Si570LeadCenter(uint32_t freq)
+{
+	uint32_t	window;
+	uint32_t	center;
+
+	if (!FreqRun)
+		return freq;
+
+	window = udiv_48_48_32_R(umul_48_32_16(freq, R.SmoothTunePPM), 1000000, 0);
+	if (FreqStep > (window >> 1))
+		return freq;
+
+	// Lead: the window minus one step, at least 1/8 window margin
+	// for the window of the center, it is smaller below freq.
+	window -= FreqStep > (window >> 3) ? FreqStep : (window >> 3);
+	center  = FreqDir > 0 ? freq + window : freq - window;
+
+	if ((R.SiChipGrade != CHIP_GRADE_D)
+	&&  ((center < R.MinimalOutputFreqeuency) || (center > R.MaximalOutputFreqeuency)) )
+		return freq;
+
+	return center;
 }
 
+// Large change to freq, it is the new smooth tune center.
+static uint8_t
+Si570LargeChange(uint32_t freq, uint8_t index)
+{
+#if INCLUDE_IMAGE_CACHE
+	image_t		image;
+
+	if (!ImageCacheCalc(freq, &image))
+		return false;
+
+	DeviceSetImage(&image);
+#else
+	if (!Si570CalcDivider(freq) || !Si570CalcRFREQ(freq, index))
+		return false;
+
+	FreqSmoothTune = freq;
+	Si570WriteLargeChange();
+#endif
+	return true;
+}
 
 // Set the freq in the Si570.
 // Use the possible smooth tuning.
 void
 SetFreqDevice(uint32_t freq, uint8_t index)
 {
+	uint32_t	center;
+
+	Si570TrackTuning(freq);
+
 	// Check low / high frequency within range of the chip.
 	if ((R.SiChipGrade == CHIP_GRADE_D)
 	||  ((freq >= R.MinimalOutputFreqeuency) && (freq <= R.MaximalOutputFreqeuency)) )
@@ -314,16 +486,114 @@ SetFreqDevice(uint32_t freq, uint8_t index)
 		}
 		else
 		{
-			if (!Si570CalcDivider(freq) || !Si570CalcRFREQ(freq, index))
-				return;
-
-			FreqSmoothTune = freq;
-			Si570WriteLargeChange();
+			// The large change ahead and a small change back to freq,
+			// freq itself when it is not possible.
+			center = R.SmoothTunePPM != 0 ? Si570LeadCenter(freq) : freq;
+			if (center != freq
+			&&  Si570LargeChange(center, index)
+			&&  Si570SmallChange(freq)
+			&&  Si570CalcRFREQ(freq, index))
+			{
+				Si570WaitNewFreq();			// The chip must have the large change first
+				Si570WriteSmallChange();
+			}
+			else
+				Si570LargeChange(freq, index);
 //PORTB &= ~_BV(PB4);		// 0
 		}
 	}
 }
 
+static void
+Si570GetImage(image_t* image)
+{
+	image->reg		= Si_Reg_Data;
+	image->center	= FreqSmoothTune;
+	image->N		= Si570_N;
+	image->N1		= Si570_N1;
+	image->HS_DIV	= Si570_HS_DIV;
+}
+
+static void
+Si570SetImage(const image_t* image)
+{
+	Si_Reg_Data		= image->reg;
+	FreqSmoothTune	= image->center;
+	Si570_N			= image->N;
+	Si570_N1		= image->N1;
+	Si570_HS_DIV	= image->HS_DIV;
+}
+
+// Calculate the registers of a large change to freq, the running
+// frequency is not changed.
+uint8_t
+DeviceCalcImage(uint32_t freq, image_t* image)
+{
+	image_t		run;
+	uint8_t		ok;
+
+	if ((R.SiChipGrade != CHIP_GRADE_D)
+	&&  ((freq < R.MinimalOutputFreqeuency) || (freq > R.MaximalOutputFreqeuency)) )
+		return false;
+
+	Si570GetImage(&run);
+
+	ok = Si570CalcDivider(freq) && Si570CalcRFREQ(freq, 0);
+	FreqSmoothTune = freq;
+	Si570GetImage(image);
+
+	Si570SetImage(&run);
+	return ok;
+}
+
+// Write the image with a large change, it is the new smooth tune center.
+void
+DeviceSetImage(const image_t* image)
+{
+	Si570SetImage(image);
+	Si570WriteLargeChange();
+}
+
+// Set freq with a small change, return false when it is not within the
+// smooth tune window of the running center.
+uint8_t
+DeviceSmoothTune(uint32_t freq)
+{
+	if ((R.SmoothTunePPM == 0) || !Si570SmallChange(freq) || !Si570CalcRFREQ(freq, 0))
+		return false;
+
+	Si570WriteSmallChange();
+	return true;
+}
+
+#if INCLUDE_PROFILE
+// CPU cycles of one Si570CalcDivider() and one Si570CalcRFREQ() call, the
+// mean of BENCH_CALLS calls in a sweep from freq. The running registers
+// are not changed.
+void
+Si570Bench(uint16_t* cycles, uint32_t freq, uint32_t step)
+{
+	image_t		run;
+	uint32_t	f;
+	uint16_t	t;
+	uint8_t		i;
+
+	Si570GetImage(&run);
+
+	t = TimerGetCounts();
+	for (i = 0, f = freq; i < BENCH_CALLS; ++i, f += step)
+		Si570CalcDivider(f);
+	cycles[0] = (TimerGetCounts() - t) * (256 / BENCH_CALLS);
+
+	t = TimerGetCounts();
+	for (i = 0, f = freq; i < BENCH_CALLS; ++i, f += step)
+		Si570CalcRFREQ(f, 0);
+	cycles[1] = (TimerGetCounts() - t) * (256 / BENCH_CALLS);
+
+	Si570SetImage(&run);
+}
+#endif
+
 
 // Check Si570 old/new 'signature' 07h, C2h, C0h, 00h, 00h, 00h
 static uint8_t
@@ -349,6 +619,7 @@ Auto_index_detect_RFREQ(void)
 	{
 		// First RECALL the Si570 to default settings.
 		Si_CmdReg(135, 0x01);
+		I2CQueueFlush();
 		_delay_us(100.0);
 
 		// Check if signature found, then it is a old or new 50/20ppm chip
@@ -402,6 +673,7 @@ DeviceOnline(void)
 
 			Auto_index_detect_RFREQ();
 			SetFreq(R.Freq, 0);
+			I2CQueueFlush();
 
 			Chip_OffLine = I2CErrors;
 		}
@@ -425,33 +697,20 @@ Si_CmdStart(uint8_t cmd)
 	return false;
 }
 
-void
-Si_CmdReg(uint8_t reg, uint8_t data)
-{
-	if (Si_CmdStart(reg))
-	{
-		I2CSendByte(data);
-	}
-	I2CSendStop();
-}
-
 // write all registers in one block from Si_Reg_Data
 static void
 Si570WriteRFREQ(void)
 {
-	if (Si_CmdStart(R.Si570RFREQIndex & RFREQ_INDEX))	// send Byte address 7/13
-	{
-		uint8_t i;
-		for (i=0;i<6;i++)				// all 6 registers
-			I2CSendByte(Si_Reg_Data.bData[i]);// send data 
-	}
-	I2CSendStop();
+	I2CWriteRegs(R.Si570RFREQIndex & RFREQ_INDEX,	// send Byte address 7/13
+			Si_Reg_Data.bData, 6);		// all 6 registers
 }
 
 // read all registers in one block to Si_Reg_Data
 uint8_t
 Si_ReadRegisters(uint8_t index)
 {
+	I2CQueueFlush();					// First the pending writes
+
 	if (Si_CmdStart(index & RFREQ_INDEX))	// send reg address 7 or 13
 	{
 		uint8_t i;
@@ -470,6 +729,35 @@ Si_ReadRegisters(uint8_t index)
 	return I2CErrors ? 0 : 6;
 }
 
+// Wait until the chip clears the NewFreq bit (135 bit 6) of the large
+// change, a RFREQ write before it is lost. At most NEW_FREQ_POLLS reads.
+static void
+Si570WaitNewFreq(void)
+{
+	uint8_t		i;
+	uint8_t		reg;
+
+	I2CQueueFlush();					// First the pending writes
+
+	for (i = 0; i < NEW_FREQ_POLLS; ++i)
+	{
+		reg = 0;
+		if (Si_CmdStart(135))
+		{
+			I2CSendStart();
+			I2CSendByte((R.ChipCrtlData<<1)|1);
+			reg = I2CReceiveByte();
+			I2CSend1();					// 1 Last byte
+		}
+		I2CSendStop();
+
+		if (I2CErrors || !(reg & (1<<6)))
+			break;
+
+		_delay_us(NEW_FREQ_POLL_US);
+	}
+}
+
 static void
 Si570WriteSmallChange(void)
 {
@@ -477,7 +765,7 @@ Si570WriteSmallChange(void)
 	{
 		// Prevents interim frequency changes when writing RFREQ registers.
 		Si_CmdReg(135, 1<<5);		// Freeze M
-		if (I2CErrors == 0)
+		if (I2C_WRITE_OK)
 		{
 			Si570WriteRFREQ();
 			Si_CmdReg(135, 0<<5);	// unFreeze M
@@ -493,7 +781,7 @@ static void
 Si570WriteLargeChange(void)
 {
 	Si_CmdReg(137, 1<<4);			// Freeze NCO
-	if (I2CErrors == 0)
+	if (I2C_WRITE_OK)
 	{
 		Si570WriteRFREQ();
 		Si_CmdReg(137, 0<<4);		// unFreeze NCO
@@ -501,5 +789,24 @@ Si570WriteLargeChange(void)
 	}
 }
 
+#if defined(DEVICE_AUTO)
+const device_t DeviceSi570 PROGMEM =
+{	.SetFreq				= SetFreqDevice
+,	.Init					= DeviceInit
+,	.Online					= DeviceOnline
+,	.ReadRegisters			= Si_ReadRegisters
+,	.CalcImage				= DeviceCalcImage
+,	.SetImage				= DeviceSetImage
+,	.SmoothTune				= DeviceSmoothTune
+,	.chip					= { CHIP_SI570, Chip_Grade_Default, Chip_Freq_Xtal }
+,	.ConfigFlags			= CONFIG_ABPF
+,	.Freq					= 0x03866666
+,	.Band2CrossOver			= { { 4.0 * 4.0 * _2(5) }, { 8.0 * 4.0 * _2(5) }, { 16.0 * 4.0 * _2(5) }, { 1 } }
+,	.SmoothTunePPM			= Chip_SmoothTunePPM
+,	.DCOMin					= Chip_DCO_Min
+,	.DCOMax					= Chip_DCO_Max
+};
+#endif
+
 #endif
 
@@ -0,0 +1,520 @@
+//************************************************************************
+//**
+//** Project......: Firmware USB AVR Si570 controler.
+//**
+//** Platform.....: ATtiny45
+//**
+//** Licence......: This software is freely available for non-commercial
+//**
+//** Programmer...: F.W. Krom, PE0FKO
+//**
+//** Description..: Write the changed R variables to the eeprom E.
+//**                The eeprom holds two copies of E, each with a header of a
+//**                version, a sequence number and the CRC-16 of the copy.
+//**                A change is written to the other copy and then its header,
+//**                the newest copy with a correct header is used at startup.
+//**                A power loss during a write leaves the last written copy.
+//**                With INCLUDE_EEPROM_CACHE the bytes are marked dirty and
+//**                written by the main loop, one byte when the eeprom is
+//**                ready. A eeprom byte write takes 3.3ms, the USB commands
+//**                do not wait for it any more.
+//**                The startup frequency E.Freq is not the running R.Freq,
+//**                it has its own copy in ram.
+//**                With INCLUDE_EEPROM_RING the startup frequency and the
+//**                xtal frequency are written in a ring of records after the
+//**                copies, every write uses the next record. The newest record
+//**                with a correct check byte is used at startup, also when
+//**                both copies are wrong and the defaults are loaded.
+//**                The last bytes of the eeprom are the two headers, the
+//**                address does not change with the size of E. A V15.16 E
+//**                (no header) keeps the defaults of the variables added
+//**                after it.
+//**
+//** History......: Check the main.c file
+//**
+//**************************************************************************
+
+#include "main.h"
+#include <stddef.h>
+#if defined(__AVR__)
+#include <util/crc16.h>
+#endif
+
+#define	EEPROM_VERSION	6								// Version of the var_t layout, 2: keyer, 3: temp comp, 4: encoder, 5: header at the end, 6: two copies
+
+typedef struct {
+	uint8_t		version;								// EEPROM_VERSION, 0xFF no header (V15.16)
+	uint8_t		seq;									// Sequence number, the newest copy is used
+	uint16_t	crc;									// CRC-16 CCITT of the copy
+} header_t;
+
+#define	COPY1_START		((sizeof(var_t) + 15) & ~15)	// Copy 0 is E (V15.16), copy 1 after it
+#define	COPY_ADDR(n)	((n) ? (uint8_t*)COPY1_START : (uint8_t*)&E)
+#define	COPY_END		(COPY1_START + sizeof(var_t))
+#define	HEADER_START	(E2END + 1 - 2 * sizeof(header_t))	// Headers at the end of the eeprom
+#define	HEADER_ADDR(n)	((uint8_t*)(HEADER_START + (n) * sizeof(header_t)))
+#define	LEGACY_SIZE		offsetof(var_t, KeyerMode)		// Size of E in V15.16
+#define	FREQ_OFFSET		offsetof(var_t, Freq)
+
+static	header_t	EepromHeader;						// Header of the active copy
+static	uint8_t		EepromActive;						// Copy with the newest settings, 0 or 1
+static	uint8_t		EepromState;						// EEPROM_xxx, startup state of E
+
+static uint16_t
+EepromCrc(uint8_t copy)
+{
+	uint8_t		i;
+	uint16_t	crc = 0xFFFF;
+
+	for (i = 0; i < sizeof(var_t); ++i)
+		crc = _crc_ccitt_update(crc, eeprom_read_byte(COPY_ADDR(copy) + i));
+
+	return crc;
+}
+
+// Write the header of the copy, the version as the last byte. A header
+// that is not complete has the old sequence number or a wrong CRC.
+static void
+EepromWriteHeader(uint8_t copy)
+{
+	EepromHeader.version = EEPROM_VERSION;
+	EepromHeader.crc = EepromCrc(copy);
+	eeprom_write_block(&EepromHeader.crc, HEADER_ADDR(copy) + offsetof(header_t, crc), sizeof(EepromHeader.crc));
+	eeprom_write_block(&EepromHeader.seq, HEADER_ADDR(copy) + offsetof(header_t, seq), sizeof(EepromHeader.seq));
+	eeprom_write_byte(HEADER_ADDR(copy) + offsetof(header_t, version), EepromHeader.version);
+	EepromActive = copy;
+}
+
+#if INCLUDE_EEPROM_CACHE
+
+static	uint8_t		EepromDirty[(sizeof(var_t)+7)/8];	// Bit for every byte of R changed after the active copy
+static	uint8_t		EepromPending;						// A byte is dirty, the other copy is written
+static	uint8_t		EepromNext;							// Next byte to check
+static	uint8_t		EepromHeaderLeft;					// Bytes of the new header still to write
+static	uint32_t	EepromStartupFreq;					// Ram copy of E.Freq
+
+#if INCLUDE_EEPROM_RING
+
+typedef struct {
+	uint8_t		seq;									// Sequence number of the record
+	uint32_t	freq;									// Startup frequency [11.21]
+	uint32_t	xtal;									// Crystal frequency [8.24]
+	uint8_t		check;									// ~sum of the bytes before
+} ring_t;
+
+#define	RING_START		((COPY_END + 15) & ~15)			// First free eeprom after the copies
+#define	RING_SIZE		((HEADER_START - RING_START) / sizeof(ring_t))
+#define	RING_ADDR(n)	((uint8_t*)(RING_START + (n) * sizeof(ring_t)))
+#define	RING_MIN		16								// Records for the wear leveling, 28 ATtiny85, 79 ATmega328P
+
+typedef char RingCheckSize[RING_SIZE >= RING_MIN ? 1 : -1];	// Compile error when var_t leaves no room for the ring
+
+#define	SAVE_FREQ_DELAY_MS	2000						// CONFIG_SAVE_FREQ, frequency stable time
+
+static	ring_t		RingRec;							// Record to write
+static	uint8_t		RingNext;							// Record number to write
+static	uint8_t		RingStep;							// Next byte of the record, sizeof(ring_t) is done
+static	uint32_t	RingFreq;							// Frequency for CONFIG_SAVE_FREQ
+static	uint16_t	RingTime;							//   and the tick it was set
+static	uint8_t		RingCommit;							// EepromCommit(), save RingFreq now
+
+static uint8_t
+RingCheck(const ring_t* r)
+{
+	uint8_t		i;
+	uint8_t		sum = 0;
+
+	for (i = 0; i < offsetof(ring_t, check); ++i)
+		sum += ((const uint8_t*)r)[i];
+
+	return ~sum;
+}
+
+// Find the newest record, return false if there is no record
+static uint8_t
+RingLoad(void)
+{
+	ring_t		r;
+	uint8_t		i;
+	uint8_t		found = false;
+
+	RingNext = 0;
+	RingRec.seq = 0xFF;
+
+	for (i = 0; i < RING_SIZE; ++i)
+	{
+		eeprom_read_block(&r, RING_ADDR(i), sizeof(r));
+		if (r.check != RingCheck(&r))
+			continue;
+
+		// The records in the ring are within RING_SIZE sequence numbers
+		if (!found || (int8_t)(r.seq - RingRec.seq) > 0)
+		{
+			RingRec  = r;
+			RingNext = i + 1 < RING_SIZE ? i + 1 : 0;
+			found    = true;
+		}
+	}
+
+	RingStep = sizeof(ring_t);
+	return found;
+}
+
+// Start the write of a new record with the startup and xtal frequency
+static void
+RingSave(void)
+{
+	RingRec.seq++;
+	RingRec.freq  = EepromStartupFreq;
+	RingRec.xtal  = R.FreqXtal;
+	RingRec.check = RingCheck(&RingRec);
+	RingStep = 0;
+}
+
+#endif
+
+static void
+EepromMark(uint8_t offset, uint8_t size)
+{
+	EepromPending = true;
+
+	while (size--)
+	{
+		EepromDirty[offset >> 3] |= _BV(offset & 7);
+		offset++;
+	}
+}
+
+// The byte of the new copy: the changed byte of R, or the byte of the active copy
+static uint8_t
+EepromData(uint8_t offset)
+{
+	if (!(EepromDirty[offset >> 3] & _BV(offset & 7)))
+		return eeprom_read_byte(COPY_ADDR(EepromActive) + offset);
+
+	if ((uint8_t)(offset - FREQ_OFFSET) < sizeof(E.Freq))
+		return ((uint8_t*)&EepromStartupFreq)[offset - FREQ_OFFSET];
+
+	return ((uint8_t*)&R)[offset];
+}
+
+// Defaults is true when E is just written with the defaults of R.
+static void
+EepromInit(uint8_t defaults)
+{
+	EepromStartupFreq = R.Freq;			// R is just loaded from E
+
+#if INCLUDE_EEPROM_RING
+	if (RingLoad())
+	{
+		if (defaults)					// The old record must not overrule the defaults
+			RingSave();
+		else
+		{
+			EepromStartupFreq = R.Freq = RingRec.freq;
+			R.FreqXtal = RingRec.xtal;
+		}
+	}
+
+	RingFreq = R.Freq;
+#endif
+}
+
+// Mark the changed variable in R to be written to E.
+void
+EepromWrite(const void* r, uint8_t size)
+{
+#if INCLUDE_EEPROM_RING
+	if (r == &R.FreqXtal)
+	{
+		RingSave();
+		return;
+	}
+#endif
+
+	EepromMark((uint8_t)((const uint8_t*)r - (const uint8_t*)&R), size);
+}
+
+void
+EepromSetStartup(uint32_t freq)
+{
+	EepromStartupFreq = freq;
+
+#if INCLUDE_EEPROM_RING
+	RingSave();
+#else
+	EepromMark(FREQ_OFFSET, sizeof(E.Freq));
+#endif
+}
+
+uint32_t
+EepromGetStartup(void)
+{
+	return EepromStartupFreq;
+}
+
+// Write one byte, if the eeprom is ready. The changed bytes go to the
+// other copy, when all are written its header makes it the active copy.
+void
+EepromPoll(void)
+{
+	uint8_t		i;
+	uint8_t		data;
+	uint8_t		copy = EepromActive ^ 1;
+
+#if INCLUDE_EEPROM_RING
+	// Save the running frequency as startup frequency, if it did not change for a while
+	if (R.ConfigFlags & CONFIG_SAVE_FREQ)
+	{
+		if (RingFreq != R.Freq)
+		{
+			RingFreq = R.Freq;
+			RingTime = TimerGetTicks();
+		}
+
+		if (RingFreq != EepromStartupFreq
+		&&	(RingCommit || (uint16_t)(TimerGetTicks() - RingTime) >= SAVE_FREQ_DELAY_MS))
+		{
+			EepromSetStartup(RingFreq);
+		}
+	}
+	RingCommit = false;
+#endif
+
+	if (!eeprom_is_ready())
+		return;
+
+	// The header of the new copy, the version byte is the last
+	if (EepromHeaderLeft != 0)
+	{
+		EepromHeaderLeft--;
+		eeprom_write_byte(HEADER_ADDR(copy) + EepromHeaderLeft, ((uint8_t*)&EepromHeader)[EepromHeaderLeft]);
+		if (EepromHeaderLeft == 0)
+			EepromActive = copy;
+		return;
+	}
+
+	if (EepromPending)
+	{
+		for (i = 0; i < sizeof(var_t); ++i)
+		{
+			uint8_t offset = EepromNext;
+
+			if (++EepromNext == sizeof(var_t))
+				EepromNext = 0;
+
+			data = EepromData(offset);
+			if (eeprom_read_byte(COPY_ADDR(copy) + offset) != data)
+			{
+				PROFILE_START(start);
+				eeprom_write_byte(COPY_ADDR(copy) + offset, data);
+				PROFILE_STOP(PROFILE_EEPROM, start);
+				return;
+			}
+		}
+
+		// The new copy is complete, the dirty bytes are now relative to it
+		EepromPending = false;
+		memset(EepromDirty, 0, sizeof(EepromDirty));
+		EepromHeader.version = EEPROM_VERSION;
+		EepromHeader.seq++;
+		EepromHeader.crc = EepromCrc(copy);
+		EepromHeaderLeft = sizeof(header_t);
+		return;
+	}
+
+#if INCLUDE_EEPROM_RING
+	if (RingStep < sizeof(ring_t))
+	{
+		eeprom_write_byte(RING_ADDR(RingNext) + RingStep, ((uint8_t*)&RingRec)[RingStep]);
+
+		if (++RingStep == sizeof(ring_t))	// Record done, the next one
+			if (++RingNext == RING_SIZE)
+				RingNext = 0;
+	}
+#endif
+}
+
+// Number of bytes not written to the eeprom
+uint8_t
+EepromDirtyCount(void)
+{
+	uint8_t		i;
+	uint8_t		n = EepromHeaderLeft;
+
+	if (EepromPending)
+	{
+		for (i = 0; i < sizeof(var_t); ++i)
+			if (eeprom_read_byte(COPY_ADDR(EepromActive ^ 1) + i) != EepromData(i))
+				n++;
+		n += sizeof(header_t);
+	}
+
+#if INCLUDE_EEPROM_RING
+	n += sizeof(ring_t) - RingStep;
+	if (RingCommit && (R.ConfigFlags & CONFIG_SAVE_FREQ) && R.Freq != EepromStartupFreq)
+		n += sizeof(ring_t);					// Saved by the next EepromPoll()
+#endif
+
+	return n;
+}
+
+// Write all changed settings without waiting, the main loop writes them.
+// With CONFIG_SAVE_FREQ the running frequency is saved at once.
+void
+EepromCommit(void)
+{
+#if INCLUDE_EEPROM_RING
+	RingCommit = true;
+#endif
+}
+
+// Write all dirty bytes, can take 3.3ms for every byte.
+void
+EepromFlush(void)
+{
+	while (EepromDirtyCount() != 0)
+	{
+		wdt_reset();
+		eeprom_busy_wait();
+		EepromPoll();
+	}
+	eeprom_busy_wait();
+}
+
+#else
+
+// Write the other copy with the size bytes of data at offset and the
+// rest of the active copy, then its header.
+static void
+EepromCopy(uint8_t offset, uint8_t size, const void* data)
+{
+	uint8_t		i;
+	uint8_t		copy = EepromActive ^ 1;
+	uint8_t		byte;
+
+	for (i = 0; i < sizeof(var_t); ++i)
+	{
+		if ((uint8_t)(i - offset) < size)
+			byte = ((const uint8_t*)data)[i - offset];
+		else
+			byte = eeprom_read_byte(COPY_ADDR(EepromActive) + i);
+
+		if (eeprom_read_byte(COPY_ADDR(copy) + i) != byte)
+			eeprom_write_byte(COPY_ADDR(copy) + i, byte);
+	}
+
+	EepromHeader.seq++;
+	EepromWriteHeader(copy);
+}
+
+void
+EepromWrite(const void* r, uint8_t size)
+{
+	PROFILE_START(start);
+	EepromCopy((uint8_t)((const uint8_t*)r - (const uint8_t*)&R), size, r);
+	PROFILE_STOP(PROFILE_EEPROM, start);
+}
+
+void
+EepromSetStartup(uint32_t freq)
+{
+	EepromCopy(FREQ_OFFSET, sizeof(E.Freq), &freq);
+}
+
+uint32_t
+EepromGetStartup(void)
+{
+	uint32_t freq;
+	eeprom_read_block(&freq, COPY_ADDR(EepromActive) + FREQ_OFFSET, sizeof(freq));
+	return freq;
+}
+
+#endif
+
+// Find the active copy and the startup state of the eeprom.
+static void
+EepromFind(void)
+{
+	header_t	h[2];
+	uint8_t		ok[2];
+	uint8_t		n;
+
+	for (n = 0; n < 2; ++n)
+	{
+		eeprom_read_block(&h[n], HEADER_ADDR(n), sizeof(header_t));
+		ok[n] = h[n].version == EEPROM_VERSION && h[n].crc == EepromCrc(n);
+	}
+
+	EepromActive = ok[1] && (!ok[0] || (int8_t)(h[1].seq - h[0].seq) > 0);
+	EepromHeader = h[EepromActive];
+
+	if (ok[0] || ok[1])
+		EepromState = EEPROM_OK;
+	else
+	if (h[0].version != 0xFF || h[1].version != 0xFF)
+		EepromState = EEPROM_CRC_ERROR;
+	else
+	// Check if eeprom is initialized, use only the field ChipCrtlData.
+	if (eeprom_read_byte(&E.ChipCrtlData) == 0xFF)
+		EepromState = EEPROM_DEFAULTS;
+	else
+		EepromState = EEPROM_LEGACY;
+}
+
+// Read a byte of the settings from the eeprom, before EepromLoad().
+uint8_t
+EepromReadByte(const void* r)
+{
+	EepromFind();
+	return eeprom_read_byte(COPY_ADDR(EepromActive) + ((const uint8_t*)r - (const uint8_t*)&R));
+}
+
+// Load R from the newest correct copy of E, or write the defaults of R to a
+// empty or wrong E. A E without header (V15.16) is accepted and gets the
+// header, the variables added after V15.16 get the defaults of R.
+void
+EepromLoad(void)
+{
+	EepromFind();
+
+	if (EepromState == EEPROM_OK)
+		eeprom_read_block(&R, COPY_ADDR(EepromActive), sizeof(E));	// Load the persistend data from eeprom.
+	else
+	if (EepromState == EEPROM_LEGACY)
+	{
+		eeprom_read_block(&R, &E, LEGACY_SIZE);	// Load the V15.16 part, and the defaults of the rest
+		eeprom_write_block((uint8_t*)&R + LEGACY_SIZE, (uint8_t*)&E + LEGACY_SIZE, sizeof(E) - LEGACY_SIZE);
+	}
+	else
+		eeprom_write_block(&R, &E, sizeof(E));	// Initialize eeprom to "factory defaults".
+
+	if (EepromState != EEPROM_OK)
+	{
+		EepromHeader.seq = 0;
+		EepromWriteHeader(0);
+	}
+
+#if INCLUDE_EEPROM_CACHE
+	// A CRC error keeps the startup and xtal frequency of the ring
+	EepromInit(EepromState == EEPROM_DEFAULTS);
+#endif
+}
+
+// Startup state of E, EEPROM_xxx
+uint8_t
+EepromGetState(void)
+{
+	return EepromState;
+}
+
+// Reply: version, CRC of the header of the active copy and the startup state
+uint8_t
+EepromStatus(uint8_t* reply)
+{
+	reply[0] = EepromHeader.version;
+	reply[1] = EepromHeader.crc & 0xFF;
+	reply[2] = EepromHeader.crc >> 8;
+	reply[3] = EepromState;
+	return 4;
+}
@@ -0,0 +1,160 @@
+//************************************************************************
+//**
+//** Project......: Firmware USB AVR Si570 controler.
+//**
+//** Platform.....: ATmega328P
+//**
+//** Licence......: This software is freely available for non-commercial
+//**                use - i.e. for research and experimentation only!
+//**
+//** Programmer...: F.W. Krom, PE0FKO
+//**
+//** Description..: Rotary encoder tuning on PC0 (A) and PC1 (B), the
+//**                ATmega328P port C is not used by the firmware.
+//**                The pin change interrupt decodes the quadrature, the
+//**                main loop changes the frequency with the step of the
+//**                table R.EncoderStep, a faster turn uses a bigger step.
+//**                The host gets the new frequency from the interrupt
+//**                endpoint.
+//**
+//** History......: Check the main.c file
+//**
+//**************************************************************************
+
+#include "main.h"
+#include <util/atomic.h>
+
+#if INCLUDE_ENCODER
+
+#define	ENCODER_DDR			DDRC
+#define	ENCODER_PORT		PORTC
+#define	ENCODER_PIN			PINC
+#define	ENCODER_A			PC0
+#define	ENCODER_B			PC1
+#define	ENCODER_DETENT		4					// Quadrature changes of one detent
+
+static	const uint32_t			EncoderStepDefault[ENCODER_STEPS] PROGMEM = ENCODER_STEP_DEFAULT;
+
+// Time between the detents [ms] for the next step of the table.
+static	const uint8_t		EncoderSpeed[ENCODER_STEPS-1] PROGMEM = { 100, 40, 15 };
+
+// Count of the old and new state (A,B), the invalid changes count zero.
+static	const int8_t		EncoderTable[16] PROGMEM =
+{
+	 0, +1, -1,  0,
+	-1,  0,  0, +1,
+	+1,  0,  0, -1,
+	 0, -1, +1,  0
+};
+
+static	uint8_t				EncoderState;		// Last state of the A & B lines
+static	volatile int8_t		EncoderCount;		// Quadrature changes not yet used
+static	uint16_t			EncoderTime;		// Tick of the last detent
+
+static uint8_t
+EncoderLines(void)
+{
+	return (ENCODER_PIN >> ENCODER_A) & 0x03;
+}
+
+// The pin change interrupt is not blocking (USB), mask it while decoding.
+// A interrupt within the decoding finds it masked and does nothing, the
+// decoding reads the lines after it.
+ISR(PCINT1_vect, ISR_NOBLOCK)
+{
+	uint8_t	state;
+	uint8_t	pcie;
+	int16_t	count;
+
+	ATOMIC_BLOCK(ATOMIC_FORCEON)
+	{
+		pcie = PCICR & _BV(PCIE1);
+		PCICR &= ~_BV(PCIE1);
+	}
+
+	if (pcie)
+	{
+		state = EncoderLines();
+		count = EncoderCount + (int8_t)pgm_read_byte(&EncoderTable[(EncoderState << 2) | state]);
+		if (count >= INT8_MIN && count <= INT8_MAX)	// Saturate, a fast turn must not wrap the direction
+			EncoderCount = count;
+		EncoderState = state;
+	}
+
+	ATOMIC_BLOCK(ATOMIC_FORCEON)
+	{
+		PCICR |= pcie;
+	}
+}
+
+// Use the encoder steps of R, correct the steps out of range.
+void
+EncoderInit(void)
+{
+	uint8_t	i;
+
+	for (i = 0; i < ENCODER_STEPS; ++i)
+		if (R.EncoderStep[i] == 0 || R.EncoderStep[i] > ENCODER_STEP_MAX)
+			R.EncoderStep[i] = pgm_read_dword(&EncoderStepDefault[i]);
+
+	ENCODER_DDR  &= ~(_BV(ENCODER_A) | _BV(ENCODER_B));
+	ENCODER_PORT |= _BV(ENCODER_A) | _BV(ENCODER_B);	// Pull-up, the encoder switches to ground
+
+	EncoderState = EncoderLines();
+	EncoderCount = 0;
+
+	PCMSK1 = _BV(ENCODER_A) | _BV(ENCODER_B);
+	PCICR |= _BV(PCIE1);
+}
+
+// Called from the main loop, change the frequency with the turned detents.
+void
+EncoderPoll(void)
+{
+	int8_t		detents;
+	uint8_t		n, step;
+	uint16_t	tick, time;
+	uint32_t	freq;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		detents = EncoderCount / ENCODER_DETENT;
+		EncoderCount -= detents * ENCODER_DETENT;
+	}
+
+	if (detents == 0)
+		return;
+
+	// Speed of the turn, the time of one detent since the last change.
+	n = detents < 0 ? -detents : detents;
+	tick = TimerGetTicks();
+	time = (uint16_t)(tick - EncoderTime) / n;
+	EncoderTime = tick;
+
+	for (step = 0; step < ENCODER_STEPS-1; ++step)
+		if (time >= pgm_read_byte(&EncoderSpeed[step]))
+			break;
+
+	freq = R.EncoderStep[step] * n;
+	if (detents < 0)
+	{
+		if (freq > R.Freq)						// No wrap below zero
+			return;
+		freq = R.Freq - freq;
+	}
+	else
+	{
+		if (R.Freq >= R.MaximalOutputFreqeuency)	// No wrap above the chip maximum
+			return;
+		if (freq > R.MaximalOutputFreqeuency - R.Freq)
+			freq = R.MaximalOutputFreqeuency;
+		else
+			freq = R.Freq + freq;
+	}
+
+	SetFreq(freq, 0);
+
+	EventAdd(INTR_CMD_FREQ_CHANGE, freq);		// Freq changed interrupt to the host
+}
+
+#endif
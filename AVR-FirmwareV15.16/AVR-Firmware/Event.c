@@ -0,0 +1,160 @@
+//************************************************************************
+//**
+//** Project......: Firmware USB AVR Si570 controler.
+//**
+//** Platform.....: ATtiny45
+//**
+//** Licence......: This software is freely available for non-commercial
+//**                use - i.e. for research and experimentation only!
+//**
+//** Programmer...: F.W. Krom, PE0FKO
+//**
+//** Description..: Events send by the USB interrupt endpoint.
+//**                The main loop checks the I/O pins (PTT, CW keys), the
+//**                frequency, the I2C errors, the chip on-line state and
+//**                the keyer key state.
+//**                A change is put in a ring with the millisecond tick, and
+//**                send when the interrupt endpoint is free.
+//**                Packet: cmd, data (1 or 4 bytes), tick (2 bytes).
+//**                Only with the config bit CONFIG_INTERRUPT.
+//**
+//** History......: Check the main.c file
+//**
+//**************************************************************************
+
+#include "main.h"
+
+#if INCLUDE_INTERRUPT							// Include the usb interrupt code
+
+#if defined (__AVR_ATmega328P__)
+#define	EVENT_RING_SIZE		8					// Events not yet send, power of 2
+#else
+#define	EVENT_RING_SIZE		4					// Less RAM on the ATtiny
+#endif
+
+typedef struct {
+	uint8_t		cmd;							// INTR_CMD_xxx
+	uint32_t	data;							// IO pins, frequency, I2C error or on-line
+	uint16_t	tick;							// TimerGetTicks() of the change
+} event_t;
+
+static	event_t		EventRing[EVENT_RING_SIZE];
+static	uint8_t		EventHead;					// First event to send
+static	uint8_t		EventCount;					// Events in the ring
+static	uint8_t		EventIo;					// Last IO pins
+		uint32_t	EventFreq;					// Last frequency, SetFreq() sets it
+#if defined(DEVICE_SI570) || defined(DEVICE_SI549)
+static	uint8_t		EventI2CErrors;				// Last I2C error state
+static	uint8_t		EventOffLine;				// Last chip off-line state
+#endif
+#if INCLUDE_KEYER
+static	uint8_t		EventKey;					// Last keyer key state
+#endif
+
+// Put the event in the ring, a full ring drops the oldest event.
+static void
+EventAddTick(uint8_t cmd, uint32_t data, uint16_t tick)
+{
+	event_t*	e;
+
+	if (!(R.ConfigFlags & CONFIG_INTERRUPT))
+		return;
+
+	if (EventCount == EVENT_RING_SIZE)
+	{
+		EventHead = (EventHead + 1) & (EVENT_RING_SIZE-1);
+		EventCount--;
+	}
+
+	e = &EventRing[(EventHead + EventCount) & (EVENT_RING_SIZE-1)];
+	e->cmd  = cmd;
+	e->data = data;
+	e->tick = tick;
+	EventCount++;
+}
+
+// Put the event with the tick of now in the ring. SetFreq() of the firmware
+// itself (sweep, encoder) sends no frequency event, they add it with this.
+void
+EventAdd(uint8_t cmd, uint32_t data)
+{
+	EventAddTick(cmd, data, TimerGetTicks());
+}
+
+void
+EventInit(void)
+{
+	EventIo   = IO_PIN;
+	EventFreq = R.Freq;
+#if defined(DEVICE_SI570) || defined(DEVICE_SI549)
+	EventOffLine = Chip_OffLine;
+#endif
+}
+
+// Called from the main loop, check for changes and send the first event.
+void
+EventPoll(void)
+{
+	uint8_t		io = IO_PIN;
+
+	if ((EventIo ^ io) & R.IntrMaskIo)
+	{
+		EventIo = io;
+		EventAdd(INTR_CMD_IO_CHANGE, io);
+	}
+
+#if INCLUDE_KEYER
+	{
+		uint16_t	tick;
+		uint8_t		key = KeyerGetState(&tick);
+
+		if (EventKey != key)					// Tick of the key change by the keyer
+		{
+			EventKey = key;
+			EventAddTick(INTR_CMD_KEY, key, tick);
+		}
+	}
+#endif
+
+#if INCLUDE_I2C_QUEUE
+	if (I2CQueueCount == 0)						// Only if the freq is written to the device
+#endif
+	{
+		if (EventFreq != R.Freq)
+		{
+			EventFreq = R.Freq;
+			EventAdd(INTR_CMD_FREQ_CHANGE, EventFreq);
+		}
+
+#if defined(DEVICE_SI570) || defined(DEVICE_SI549)
+		if (EventI2CErrors != I2CErrors)
+		{
+			EventI2CErrors = I2CErrors;
+			EventAdd(INTR_CMD_I2C_ERROR, EventI2CErrors);
+		}
+
+		if (EventOffLine != Chip_OffLine)
+		{
+			EventOffLine = Chip_OffLine;
+			EventAdd(INTR_CMD_ONLINE, !EventOffLine);
+		}
+#endif
+	}
+
+	if (EventCount != 0 && usbInterruptIsReady())
+	{
+		event_t*	e = &EventRing[EventHead];
+		uint8_t		buf[1 + sizeof(e->data) + sizeof(e->tick)];
+		uint8_t		len = e->cmd == INTR_CMD_FREQ_CHANGE ? sizeof(e->data) : sizeof(uint8_t);
+
+		buf[0] = e->cmd;
+		memcpy(&buf[1], &e->data, len);
+		memcpy(&buf[1 + len], &e->tick, sizeof(e->tick));
+		usbSetInterrupt(buf, 1 + len + sizeof(e->tick));
+
+		EventHead = (EventHead + 1) & (EVENT_RING_SIZE-1);
+		EventCount--;
+	}
+}
+
+#endif
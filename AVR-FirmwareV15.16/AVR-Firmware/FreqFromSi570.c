@@ -53,8 +53,10 @@ CalcFreqFromRegSi570(uint8_t* reg)
 	//  Freq = F_DCO/N is also [19.21], but the first 8 bits are
 	//  always 0, ignore them -> Freq is [11.21] in (A2, A1, A0, B4).
 
+#if defined(__AVR__)
 	uint8_t		cnt;
 	uint8_t		A0,A1,A2,A3,B0,B1,B2,B3,B4;
+#endif
 	uint8_t		N1,HS_DIV;
 	uint16_t	N;
 //	sint32_t	Freq;
@@ -66,6 +68,8 @@ CalcFreqFromRegSi570(uint8_t* reg)
 	HS_DIV = HS_DIV + 4;
 	N = HS_DIV * N1;
 
+#if defined(__AVR__)
+
 	A0 = 0;
 	A1 = 0;
 	A2 = 0;
@@ -206,6 +210,24 @@ CalcFreqFromRegSi570(uint8_t* reg)
 	, "7" (cnt)				// 			Loop counter
 	);
 
+#else
+
+	// Host version of the two loops above, with the same truncation.
+	// F_DCO [19.21] = (xtal * RFREQ) >> 31, RFREQ split in [5..0] and [31..0] bits.
+	uint64_t	dco;
+
+	dco  = ((uint64_t)0x7248F5C2 * (((uint32_t)reg[2] << 24) | ((uint32_t)reg[3] << 16)
+								  | ((uint32_t)reg[4] << 8) | reg[5])) >> 31;
+	dco += ((uint64_t)0x7248F5C2 * (reg[1] & 0x3F)) << 1;
+	dco  = (dco & 0xFFFFFFFFFFULL) / N;
+
+	reg[0] = (uint8_t)(dco);
+	reg[1] = (uint8_t)(dco >> 8);
+	reg[2] = (uint8_t)(dco >> 16);
+	reg[3] = (uint8_t)(dco >> 24);
+
+#endif
+
 //	SetFreq(Freq.dw, R.Si570_PPM != 0);
 }
 
@@ -0,0 +1,171 @@
+//************************************************************************
+//**
+//** Project......: Firmware USB AVR Si570 controler.
+//**
+//** Platform.....: Host PC (gcc), not the AVR chip
+//**
+//** Licence......: This software is freely available for non-commercial
+//**                use - i.e. for research and experimentation only!
+//**
+//** Programmer...: F.W. Krom, PE0FKO
+//**
+//** Description..: Host timing of the frequency math of CalcVFO.c and
+//**                DeviceSi570.c / DeviceSi549.c over a frequency sweep, the
+//**                time of one call in ns. The host time is not the AVR
+//**                time, it compares two versions of the code on the same PC.
+//**                The AVR cycles are measured by the firmware, command 0x5F
+//**                of a INCLUDE_PROFILE build.
+//**                Si570: Si570CalcDivider(), Si570CalcRFREQ(), Si570SmallChange()
+//**                Si549: CalculateFrequencyRegisters(), Si549SmallChange()
+//**                Both:  CalcFreqMulAdd()
+//**                Build:
+//**                  gcc -O2 -std=gnu99 -funsigned-char -fpack-struct -I. -DDEVICE_SI570 -o Si570Bench FreqMathBench.c
+//**                  gcc -O2 -std=gnu99 -funsigned-char -fpack-struct -I. -DDEVICE_SI549 -o Si549Bench FreqMathBench.c
+//**                Use:
+//**                  Si570Bench [calls]		Default 100000 calls a sweep
+//**
+//** History......: Check the main.c file
+//**
+//**************************************************************************
+
+#if !defined(DEVICE_SI570) && !defined(DEVICE_SI549)
+#define	DEVICE_SI570
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#if defined(DEVICE_SI570)
+#include "DeviceSi570.c"
+#else
+#include "DeviceSi549.c"
+#endif
+#include "CalcVFO.c"
+#include "I2CQueue.c"
+
+volatile uint8_t	DDRB, PORTB, PINB;
+uint8_t				I2CErrors;
+
+void	I2CSendStart(void)			{ }
+void	I2CSendStop(void)			{ }
+void	I2CSendByte(uint8_t b)		{ (void)b; }
+void	I2CSend0(void)				{ }
+void	I2CSend1(void)				{ }
+uint8_t	I2CReceiveByte(void)		{ return 0; }
+
+uint8_t	eeprom_read_byte(const uint8_t* addr)						{ (void)addr; return 0xFF; }
+void	eeprom_read_block(void* dst, const void* src, size_t n)		{ (void)src; memset(dst, 0xFF, n); }
+void	eeprom_write_byte(uint8_t* addr, uint8_t value)				{ (void)addr; (void)value; }
+void	eeprom_write_word(uint16_t* addr, uint16_t value)			{ (void)addr; (void)value; }
+void	eeprom_write_block(const void* src, void* dst, size_t n)	{ (void)src; (void)dst; (void)n; }
+
+#if INCLUDE_INTERRUPT
+uint32_t			EventFreq;
+#endif
+#if INCLUDE_TEMP_COMP
+uint32_t	TempCompFreq(uint32_t freq)	{ return freq; }
+#endif
+
+#define	RUNS			5				// The fastest of the runs is reported
+#define	SWEEP_START		((uint32_t)( 10.0 * _2(21)))
+#define	SWEEP_STOP		((uint32_t)(280.0 * _2(21)))	// Grade C range of both chips
+#define	SMALL_CENTER	((uint32_t)(100.0 * _2(21)))	// Center of the small changes
+
+static	volatile uint32_t	Sink;		// Keeps the results of the calls
+
+static double
+Now(void)
+{
+	struct timespec	t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+// The sweep frequency i of calls
+static uint32_t
+Sweep(long i, long calls)
+{
+	return SWEEP_START + (uint32_t)((uint64_t)(SWEEP_STOP - SWEEP_START) * i / calls);
+}
+
+// The small change frequency i of calls, +/- 90% of the smooth tune window
+static uint32_t
+Small(long i, long calls)
+{
+	uint32_t	bound = (uint32_t)((uint64_t)SMALL_CENTER * R.SmoothTunePPM * 9 / 10 / 1000000);
+
+	return SMALL_CENTER - bound + (uint32_t)((uint64_t)2 * bound * i / calls);
+}
+
+static void
+Report(const char* name, double ns, long calls)
+{
+	printf("  %-32s %8.1f ns\n", name, ns / calls);
+}
+
+#define	TIME(ns, code)									\
+	do {												\
+		int		run_;									\
+		double	t_;										\
+		ns = 1e30;										\
+		for (run_ = 0; run_ < RUNS; ++run_)				\
+		{												\
+			t_ = Now();									\
+			code;										\
+			t_ = Now() - t_;							\
+			if (t_ < ns)								\
+				ns = t_;								\
+		}												\
+	} while (0)
+
+int
+main(int argc, char** argv)
+{
+	long		calls = argc > 1 ? atol(argv[1]) : 100000;
+	long		i;
+	double		ns;
+#if defined(DEVICE_SI570)
+	double		base;
+#endif
+
+	if (calls <= 0)
+	{
+		fprintf(stderr, "Calls %s is not valid\n", argv[1]);
+		return 2;
+	}
+
+	R.SiChipGrade = CHIP_GRADE_C;
+	DeviceInit();
+
+	printf("%ld calls, sweep %.3f - %.3f MHz, small changes around %.3f MHz, %u PPM\n",
+		calls, SWEEP_START / (double)_2(21), SWEEP_STOP / (double)_2(21),
+		SMALL_CENTER / (double)_2(21), R.SmoothTunePPM);
+
+	TIME(ns, for (i = 0; i < calls; ++i) Sink += CalcFreqMulAdd(Sweep(i, calls), 0, 4 * _2(21)));
+	Report("CalcFreqMulAdd()", ns, calls);
+
+#if defined(DEVICE_SI570)
+	TIME(base, for (i = 0; i < calls; ++i) Sink += Si570CalcDivider(Sweep(i, calls)));
+	Report("Si570CalcDivider()", base, calls);
+
+	// The RFREQ needs the divider of its frequency, the divider time is subtracted
+	TIME(ns, for (i = 0; i < calls; ++i) { Si570CalcDivider(Sweep(i, calls)); Sink += Si570CalcRFREQ(Sweep(i, calls), 0); });
+	Report("Si570CalcRFREQ()", ns - base, calls);
+
+	Si570CalcDivider(SMALL_CENTER);
+	FreqSmoothTune = SMALL_CENTER;
+	TIME(ns, for (i = 0; i < calls; ++i) Sink += Si570SmallChange(Small(i, calls)));
+	Report("Si570SmallChange()", ns, calls);
+#else
+	TIME(ns, for (i = 0; i < calls; ++i) { CalculateFrequencyRegisters(Sweep(i, calls)); Sink += Si_Reg_Data.FBDIV_7_0; });
+	Report("CalculateFrequencyRegisters()", ns, calls);
+
+	CalculateFrequencyRegisters(SMALL_CENTER);
+	Si549SetCenter(SMALL_CENTER);
+	TIME(ns, for (i = 0; i < calls; ++i) Sink += Si549SmallChange(Small(i, calls)));
+	Report("Si549SmallChange()", ns, calls);
+#endif
+
+	return 0;
+}
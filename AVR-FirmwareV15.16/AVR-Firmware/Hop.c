@@ -0,0 +1,163 @@
+//************************************************************************
+//**
+//** Project......: Firmware USB AVR Si570 controler.
+//**
+//** Platform.....: ATtiny45
+//**
+//** Licence......: This software is freely available for non-commercial
+//**                use - i.e. for research and experimentation only!
+//**
+//** Programmer...: F.W. Krom, PE0FKO
+//**
+//** Description..: Frequency hop table, a list of frequencies with the dwell
+//**                time of each. The registers of every frequency are
+//**                calculated when the entry is set, the Timer0 interrupt
+//**                counts the dwell time and marks the next hop, the main
+//**                loop only writes the register image to the chip.
+//**
+//** History......: Check the main.c file
+//**
+//**************************************************************************
+
+#include "main.h"
+#if defined(__AVR__)
+#include <util/atomic.h>
+#endif
+
+#if INCLUDE_HOP
+
+#define	HOP_ENTRIES			16					// Entries of the hop table
+
+typedef struct {
+	uint32_t	freq;							// Frequency [11.21], as SetFreq
+	uint16_t	dwell;							// Time on this frequency [ms]
+	uint8_t		filter;							// Filter of the band
+	uint8_t		valid;							// The frequency is possible, image is used
+	image_t		image;							// Registers of the device frequency
+} hop_t;
+
+static	hop_t				HopTable[HOP_ENTRIES];
+static	uint8_t				HopCount;			// Entries used in the hops
+static	volatile uint8_t	HopIndex;			// Entry of the running hop
+static	volatile uint8_t	HopLoops;			// Loops to go, 0 is endless
+static	volatile uint16_t	HopTime;			// Time to the next hop [ms], 0 is stopped
+static	volatile uint8_t	HopDue;				// Hop to HopIndex not yet written
+
+// Calculate the registers of a entry, false if the frequency is not possible.
+static uint8_t
+HopCalc(hop_t* h)
+{
+	h->valid = DeviceCalcImage(CalcFreqDevice(h->freq, &h->filter), &h->image);
+	return h->valid;
+}
+
+// Set a entry of the table and calculate the registers, this stops the hops.
+// Return false if the entry or the frequency is not possible, the hop to a
+// entry that is not possible keeps the frequency of the entry before.
+uint8_t
+HopSetEntry(uint8_t index, uint32_t freq, uint16_t dwell)
+{
+	hop_t*		h;
+
+	HopStart(0, 0);
+
+	if (index >= HOP_ENTRIES)
+		return false;
+
+	h = &HopTable[index];
+	h->dwell = dwell != 0 ? dwell : 1;
+	h->freq  = freq;
+
+	return HopCalc(h);
+}
+
+// Calculate the registers again with the new xtal, grade or DCO limits.
+void
+HopRecalc(void)
+{
+	uint8_t		i;
+
+	for (i = 0; i < HOP_ENTRIES; ++i)
+		if (HopTable[i].freq != 0)
+			HopCalc(&HopTable[i]);
+}
+
+// Start the hops of the first count entries, count 0 stops the hops.
+void
+HopStart(uint8_t count, uint8_t loops)
+{
+	if (count > HOP_ENTRIES)
+		count = HOP_ENTRIES;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		HopCount = count;
+		HopLoops = loops;
+		HopIndex = 0;
+		HopTime  = count != 0 ? HopTable[0].dwell : 0;
+		HopDue   = count != 0;
+	}
+}
+
+// Reply: running entry, loops to go, ms to the next hop (0 stopped).
+uint8_t
+HopStatus(uint8_t* reply)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		reply[0] = HopIndex;
+		reply[1] = HopLoops;
+		memcpy(&reply[2], (const void*)&HopTime, sizeof(HopTime));
+	}
+	return 2 + sizeof(HopTime);
+}
+
+// Called by the Timer0 interrupt every millisecond, the next dwell time
+// starts here so the main loop delay does not add up.
+void
+HopTick(void)
+{
+	if (HopTime == 0 || --HopTime != 0)
+		return;
+
+	if (++HopIndex == HopCount)
+	{
+		HopIndex = 0;
+
+		if (HopLoops != 0 && --HopLoops == 0)	// Last loop done, stay on the last entry
+		{
+			HopIndex = HopCount - 1;
+			return;
+		}
+	}
+
+	HopTime = HopTable[HopIndex].dwell;
+	HopDue  = true;
+}
+
+// Called from the main loop, write the registers of a due hop.
+void
+HopPoll(void)
+{
+	hop_t*		h;
+
+	if (!HopDue)
+		return;
+
+	HopDue = false;
+	h = &HopTable[HopIndex];
+
+	if (!h->valid)								// Frequency not possible
+		return;
+
+	R.Freq = h->freq;
+#if INCLUDE_INTERRUPT							// Include the usb interrupt code
+	EventFreq = h->freq;						// No freq interrupt for every hop
+#endif
+
+	SetFilter(h->filter);
+	if (!DeviceSmoothTune(h->image.center))		// Within the smooth tune window no large change
+		DeviceSetImage(&h->image);
+}
+
+#endif
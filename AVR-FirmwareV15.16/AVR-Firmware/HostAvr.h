@@ -0,0 +1,139 @@
+//************************************************************************
+//**
+//** Project......: Firmware USB AVR Si570 controler.
+//**
+//** Platform.....: Host PC (gcc), not the AVR chip
+//**
+//** Licence......: This software is freely available for non-commercial
+//**                use - i.e. for research and experimentation only!
+//**
+//** Programmer...: F.W. Krom, PE0FKO
+//**
+//** Description..: Minimal avr-libc replacement to compile the frequency
+//**                calculations on the host: CalcVFO.c, DeviceSi570.c,
+//**                DeviceSi549.c, FreqFromSi570.c and mul_div.h.
+//**                The I/O registers, the I2C and eeprom functions are only
+//**                declared, the host program must define them.
+//**                With HOST_DELAY_US the _delay_us() calls the host function,
+//**                Si5xxBusBench.c follows the I2C pins and the bus time.
+//**                The eeprom size, crc16 and ATOMIC_BLOCK of Eeprom.c and
+//**                Hop.c, the eeprom address of E is the host program's job.
+//**                The V-USB driver interface of usbdrv.h used by main.c and
+//**                CmdList.c, the host program calls usbFunctionSetup() and
+//**                usbFunctionWrite() as the driver (UsbAvrSim.c).
+//**                Example:
+//**                  gcc -std=gnu99 -funsigned-char -fpack-struct -I. -c DeviceSi549.c
+//**
+//** History......: Check the main.c file
+//**
+//**************************************************************************
+
+#ifndef _PE0FKO_HOST_AVR_H_
+#define _PE0FKO_HOST_AVR_H_ 1
+
+#if !defined(__AVR_ATtiny85__) && !defined(__AVR_ATmega328P__)
+#define	__AVR_ATtiny85__		1			// Use the SoftRock pin assignment
+#endif
+
+#ifndef F_CPU
+#define	F_CPU					16500000UL
+#endif
+
+typedef unsigned char			uchar;
+
+#define	_BV(bit)				(1 << (bit))
+
+#define	PB0						0
+#define	PB1						1
+#define	PB2						2
+#define	PB3						3
+#define	PB4						4
+#define	PB5						5
+
+extern	volatile uint8_t		DDRB;		// Defined by the host program
+extern	volatile uint8_t		PORTB;
+extern	volatile uint8_t		PINB;
+
+#define	EEMEM
+#define	PROGMEM
+#define	pgm_read_byte(addr)		(*(const uint8_t*)(addr))
+#define	pgm_read_word(addr)		(*(const uint16_t*)(addr))
+#define	memcpy_P(dst, src, n)	memcpy(dst, src, n)
+
+extern	uint8_t		eeprom_read_byte(const uint8_t* addr);
+extern	void		eeprom_read_block(void* dst, const void* src, size_t n);
+extern	void		eeprom_write_byte(uint8_t* addr, uint8_t value);
+extern	void		eeprom_write_word(uint16_t* addr, uint16_t value);
+extern	void		eeprom_write_block(const void* src, void* dst, size_t n);
+#define	eeprom_is_ready()		1
+#define	eeprom_busy_wait()		do { } while(0)
+
+#if defined(__AVR_ATmega328P__)
+#define	E2END					0x3FF
+#else
+#define	E2END					0x1FF
+#endif
+
+// util/crc16.h
+static inline uint16_t
+_crc_ccitt_update(uint16_t crc, uint8_t data)
+{
+	data ^= crc & 0xFF;
+	data ^= data << 4;
+	return ((((uint16_t)data << 8) | (crc >> 8)) ^ (uint8_t)(data >> 4) ^ ((uint16_t)data << 3));
+}
+
+// util/atomic.h, the host has no interrupts
+#define	ATOMIC_RESTORESTATE		0
+#define	ATOMIC_FORCEON			0
+#define	ATOMIC_BLOCK(type)		for (uint8_t atomic_ = 1; atomic_; atomic_ = 0)
+
+#if defined(HOST_DELAY_US)
+#define	_delay_us(us)			HOST_DELAY_US(us)
+#else
+#define	_delay_us(us)			do { } while(0)
+#endif
+#define	_delay_ms(ms)			do { } while(0)
+#define	cli()					do { } while(0)
+#define	sei()					do { } while(0)
+#define	wdt_reset()				do { } while(0)
+
+//---- V-USB driver interface (usbdrv.h, usbconfig.h)
+
+#if defined(__AVR_ATmega328P__)
+#define	USB_CFG_DMINUS_BIT		5
+#define	USB_CFG_DPLUS_BIT		3
+#else
+#define	USB_CFG_DMINUS_BIT		2
+#define	USB_CFG_DPLUS_BIT		0
+#endif
+#define	USB_CFG_SERIAL_NUMBER		'P','E','0','F','K','O','-','0'
+#define	USB_CFG_SERIAL_NUMBER_LEN	8
+#define	USB_STRING_DESCRIPTOR_HEADER(len)	((2 * (len) + 2) | (3 << 8))
+
+#define	USBRQ_TYPE_VENDOR			(2<<5)
+#define	USBRQ_DIR_MASK				0x80
+#define	USBRQ_DIR_HOST_TO_DEVICE	(0<<7)
+#define	USBRQ_DIR_DEVICE_TO_HOST	(1<<7)
+
+typedef	uchar					usbMsgLen_t;
+#define	USB_NO_MSG				((usbMsgLen_t)-1)
+
+typedef union {
+	uint16_t	word;
+	uchar		bytes[2];
+} usbWord_t;
+
+typedef struct {
+	uchar		bmRequestType;
+	uchar		bRequest;
+	usbWord_t	wValue;
+	usbWord_t	wIndex;
+	usbWord_t	wLength;
+} usbRequest_t;
+
+extern	uchar*		usbMsgPtr;				// Defined by the host program
+extern	usbMsgLen_t	usbFunctionSetup(uchar data[8]);
+extern	uchar		usbFunctionWrite(uchar* data, uchar len);
+
+#endif
@@ -0,0 +1,160 @@
+//************************************************************************
+//**
+//** Project......: Firmware USB AVR Si570 controler.
+//**
+//** Platform.....: ATtiny45
+//**
+//** Licence......: This software is freely available for non-commercial
+//**                use - i.e. for research and experimentation only!
+//**
+//** Programmer...: F.W. Krom, PE0FKO
+//**
+//** Description..: I2C register write transactions to the Si5xx chip.
+//**                With INCLUDE_I2C_QUEUE the writes are queued and send by
+//**                the main loop, one I2C byte for each I2CQueuePoll() call.
+//**                The USB command returns direct, the status command
+//**                CMD_GET_I2C_STATUS returns when the queue is empty.
+//**                On a I2C error the rest of the queue is dropped.
+//**                A failed write sets the Si549 page register unknown, the
+//**                I2CErrors flag is cleared by the next I2C start.
+//**
+//** History......: Check the main.c file
+//**
+//**************************************************************************
+
+#include "main.h"
+
+#if defined(DEVICE_SI570) || defined(DEVICE_SI549)
+
+// The transaction is not (fully) written, the chip state is not known.
+static void
+I2CWriteFailed(void)
+{
+#if defined(DEVICE_SI549)
+	Si549Page = SI549_PAGE_UNKNOWN;
+#endif
+}
+
+#if INCLUDE_I2C_QUEUE
+
+#if defined (__AVR_ATmega328P__)
+#define	I2C_QUEUE_SIZE		8				// Max transactions, Si549 large change is 8
+#else
+#define	I2C_QUEUE_SIZE		4				// Less RAM on the ATtiny, a full queue sends the first
+#endif
+#define	I2C_QUEUE_DATA		6				// Max data bytes in one transaction
+
+typedef struct {
+	uint8_t		reg;						// Register address
+	uint8_t		len;						// Number of data bytes
+	uint8_t		data[I2C_QUEUE_DATA];		// Register data
+} i2cTrans_t;
+
+static	i2cTrans_t	I2CQueue[I2C_QUEUE_SIZE];
+static	uint8_t		I2CQueueHead;			// First transaction to send
+		uint8_t		I2CQueueCount;			// Transactions in the queue
+static	uint8_t		I2CQueueStep;			// Next byte of the head transaction
+
+// Send the next byte of the first queued transaction:
+// step 0 the start and device address, 1 the register, 2.. the data
+// and as last step the stop condition.
+void
+I2CQueuePoll(void)
+{
+	i2cTrans_t*	t;
+
+	if (I2CQueueCount == 0)
+		return;
+
+	t = &I2CQueue[I2CQueueHead];
+
+	if (I2CQueueStep == 0)
+	{
+		I2CSendStart();
+		I2CSendByte((R.ChipCrtlData<<1)|0);	// send device address
+	}
+	else
+	if (I2CQueueStep == 1)
+	{
+		I2CSendByte(t->reg);				// send Byte Command
+	}
+	else
+	if (I2CQueueStep < t->len + 2)
+	{
+		I2CSendByte(t->data[I2CQueueStep - 2]);
+	}
+	else
+	{
+		I2CSendStop();
+		I2CQueueStep = 0;
+		I2CQueueHead = (I2CQueueHead + 1) & (I2C_QUEUE_SIZE-1);
+		I2CQueueCount--;
+		return;
+	}
+
+	if (I2CErrors)
+	{
+		// Do not send the next part of a frequency change
+		I2CSendStop();
+		I2CQueueStep  = 0;
+		I2CQueueCount = 0;
+		I2CWriteFailed();
+		return;
+	}
+
+	I2CQueueStep++;
+}
+
+// Send all queued transactions, needed before a read or
+// when the I2CErrors flag is used.
+void
+I2CQueueFlush(void)
+{
+	while (I2CQueueCount != 0)
+		I2CQueuePoll();
+}
+
+void
+I2CWriteRegs(uint8_t reg, const uint8_t* data, uint8_t len)
+{
+	i2cTrans_t*	t;
+
+	while (I2CQueueCount == I2C_QUEUE_SIZE)	// Queue full, send the first one
+		I2CQueuePoll();
+
+	t = &I2CQueue[(I2CQueueHead + I2CQueueCount) & (I2C_QUEUE_SIZE-1)];
+	t->reg = reg;
+	t->len = len;
+	memcpy(t->data, data, len);
+	I2CQueueCount++;
+}
+
+#else
+
+void
+I2CWriteRegs(uint8_t reg, const uint8_t* data, uint8_t len)
+{
+	I2CSendStart();
+	I2CSendByte((R.ChipCrtlData<<1)|0);	// send device address
+	if (I2CErrors == 0)
+	{
+		I2CSendByte(reg);					// send Byte Command
+		while (len--)
+			I2CSendByte(*data++);			// send data
+	}
+	I2CSendStop();
+
+	if (I2CErrors)
+		I2CWriteFailed();
+}
+
+#endif
+
+// Write one register, the same for the Si570 and the Si549.
+void
+Si_CmdReg(uint8_t reg, uint8_t data)
+{
+	I2CWriteRegs(reg, &data, 1);
+}
+
+#endif
@@ -29,46 +29,71 @@
 #define I2C_SDA_HI			I2C_DDR &= ~SDA
 #define I2C_SCL_LO			I2C_DDR |= SCL
 #define I2C_SCL_HI			I2C_DDR &= ~SCL
-#define	I2C_DELAY_uS		(1000.0 / I2C_KBITRATE)
+
+// Clock low and high time, the low time is the longest (Fast-mode 1.3us / 0.6us).
+// The low time is also the data setup time for the slow rising pull-up.
+#define	I2C_LOW_uS			(1000.0 / I2C_KBITRATE * 0.6)
+#define	I2C_HIGH_uS			(1000.0 / I2C_KBITRATE * 0.4)
 
 uint8_t	I2CErrors;
+#if INCLUDE_KEYER
+volatile uint8_t	I2CActive;					// Between start and stop, SDA is not CW key 2
+#endif
+#if INCLUDE_PROFILE
+static	uint16_t	I2CStartTime;				// Start of the transaction
+#endif
+
+static void 
+I2CDelayLow(void)
+{
+	_delay_us(I2C_LOW_uS);
+}
 
 static void 
-I2CDelay(void)
+I2CDelayHigh(void)
 {
-	_delay_us(I2C_DELAY_uS);
+	_delay_us(I2C_HIGH_uS);
 }
 
 //PE0FKO: The original code has no stop condition (hang on SCL low)
 static void 
 I2CStretch(void)						// Wait until clock hi
 {										// Terminate the loop @ max 2.1ms
-	uint16_t i = 50;					// 2.1mS
-	do {
-		I2CDelay();						// Delay some time
-		if (i-- == 0)
+	uint16_t i = 2100;					// 2.1mS
+	while(!(I2C_PIN & SCL))				// Clock line still low
+	{
+		if (--i == 0)
 		{
 			I2CErrors = true;			// Error timeout
 			break;
 		}
+		_delay_us(1);					// Delay some time
 	}
-	while(!(I2C_PIN & SCL));			// Clock line still low
+	I2CDelayHigh();						// Clock high time
 }
 
 /*
- * Generates a start condition on the bus.
+ * Generates a (repeated) start condition on the bus.
  *
- *	SDA: ..\____..
- *	       __
- *	SCL: ..  \__.. 
+ *	     ____
+ *	SDA: ..  \____..
+ *	        ___
+ *	SCL: ../   \__.. 
  */
 void 
 I2CSendStart(void)
 {
 	I2CErrors = false;					// reset error flag
-	I2C_SCL_HI;
-	I2C_SDA_LO;  	I2CDelay(); 		// Start SDA to low
-	I2C_SCL_LO;  	I2CDelay();			// and the clock low
+#if INCLUDE_KEYER
+	I2CActive = true;
+#endif
+#if INCLUDE_PROFILE
+	I2CStartTime = TimerGetCounts();
+#endif
+	I2C_SDA_HI;		I2CDelayLow();
+	I2C_SCL_HI;		I2CStretch();		// Start setup time
+	I2C_SDA_LO;  	I2CDelayHigh(); 	// Start SDA to low
+	I2C_SCL_LO;							// and the clock low
 }
 
 /*
@@ -81,32 +106,38 @@ I2CSendStart(void)
 void 
 I2CSendStop(void)
 {
-	I2C_SDA_LO;
-	I2C_SCL_HI;		I2CDelay();
-	I2C_SDA_HI;		I2CDelay();
+	I2C_SDA_LO;		I2CDelayLow();
+	I2C_SCL_HI;		I2CStretch();		// Stop setup time
+	I2C_SDA_HI;		I2CDelayLow();		// Bus free time
+#if INCLUDE_KEYER
+	I2CActive = false;
+#endif
+#if INCLUDE_PROFILE
+	ProfileAdd(PROFILE_I2C, I2CStartTime);
+#endif
 }
 
 void 
 I2CSend0(void)
 {
-	I2C_SDA_LO;							// Data low = 0
+	I2C_SDA_LO;		I2CDelayLow();		// Data low = 0
 	I2C_SCL_HI;		I2CStretch();
-	I2C_SCL_LO;		I2CDelay();
+	I2C_SCL_LO;
 }
 
 void 
 I2CSend1(void)
 {
-	I2C_SDA_HI;							// Data high = 1
+	I2C_SDA_HI;		I2CDelayLow();		// Data high = 1
 	I2C_SCL_HI;		I2CStretch();
-	I2C_SCL_LO;		I2CDelay();
+	I2C_SCL_LO;
 }
 
 static uint8_t
 I2CGetBit(void)
 {
 	uint8_t b;
-	I2C_SDA_HI;							// Data high = input (opencollector)
+	I2C_SDA_HI;		I2CDelayLow();		// Data high = input (opencollector)
 	I2C_SCL_HI;		I2CStretch();		// SDA Hi Z and wait
 	b = (I2C_PIN & SDA);				// get bit
 	I2C_SCL_LO;							// clock low
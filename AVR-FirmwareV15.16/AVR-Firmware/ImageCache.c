@@ -0,0 +1,97 @@
+//************************************************************************
+//**
+//** Project......: Firmware USB AVR Si570 controler.
+//**
+//** Platform.....: ATmega328P
+//**
+//** Licence......: This software is freely available for non-commercial
+//**                use - i.e. for research and experimentation only!
+//**
+//** Programmer...: F.W. Krom, PE0FKO
+//**
+//** Description..: Cache of the register images of the last used device
+//**                frequencies. A large change to a frequency in the cache
+//**                does not calculate the dividers and the RFREQ / FBDIV
+//**                again, the entries are in the order of the last use.
+//**                The cache is cleared when the xtal or the chip grade
+//**                changes.
+//**
+//** History......: Check the main.c file
+//**
+//**************************************************************************
+
+#include "main.h"
+
+#if INCLUDE_IMAGE_CACHE
+
+#define	IMAGE_CACHE_SIZE	4					// Frequencies in the cache
+
+typedef struct {
+	uint32_t	freq;							// Device frequency [11.21]
+	image_t		image;
+} cache_t;
+
+static	cache_t		ImageCache[IMAGE_CACHE_SIZE];	// Last used first
+static	uint8_t		ImageCacheUsed;				// Entries used
+static	uint16_t	ImageCacheHits;
+static	uint16_t	ImageCacheMisses;
+
+// The image of freq from the cache, or calculated and put in the cache.
+// Return false if the frequency is not possible.
+uint8_t
+ImageCacheCalc(uint32_t freq, image_t* image)
+{
+	cache_t		e;
+	uint8_t		i;
+
+	for (i = 0; i < ImageCacheUsed; ++i)
+		if (ImageCache[i].freq == freq)
+			break;
+
+	if (i < ImageCacheUsed)
+	{
+		ImageCacheHits++;
+		e = ImageCache[i];
+	}
+	else
+	{
+		ImageCacheMisses++;
+		if (!DeviceCalcImage(freq, &e.image))
+			return false;
+
+		e.freq = freq;
+		if (ImageCacheUsed < IMAGE_CACHE_SIZE)	// Else the last used one is dropped
+			ImageCacheUsed++;
+		i = ImageCacheUsed - 1;
+	}
+
+	memmove(&ImageCache[1], &ImageCache[0], i * sizeof(cache_t));
+	ImageCache[0] = e;
+
+	*image = e.image;
+	return true;
+}
+
+void
+ImageCacheFlush(void)
+{
+	ImageCacheUsed = 0;
+}
+
+// Reply: hits, misses and the entries used, clear the counters if asked.
+uint8_t
+ImageCacheStatus(uint8_t* reply, uint8_t clear)
+{
+	memcpy(&reply[0], &ImageCacheHits, sizeof(ImageCacheHits));
+	memcpy(&reply[2], &ImageCacheMisses, sizeof(ImageCacheMisses));
+	reply[4] = ImageCacheUsed;
+
+	if (clear)
+	{
+		ImageCacheHits   = 0;
+		ImageCacheMisses = 0;
+	}
+	return 2 * sizeof(uint16_t) + sizeof(uint8_t);
+}
+
+#endif
@@ -0,0 +1,227 @@
+//************************************************************************
+//**
+//** Project......: Firmware USB AVR Si570 controler.
+//**
+//** Platform.....: ATtiny45
+//**
+//** Licence......: This software is freely available for non-commercial
+//**                use - i.e. for research and experimentation only!
+//**
+//** Programmer...: F.W. Krom, PE0FKO
+//**
+//** Description..: CW keyer, straight key or iambic A / B paddle.
+//**                The paddles are CW key 1 (dit) and CW key 2 (dah), the
+//**                keyer output is the PTT line. A paddle change starts a
+//**                element direct from the pin change interrupt, the element
+//**                and space time is done by the Timer0 millisecond tick.
+//**                CW key 2 is also the I2C SDA line, it is not read when a
+//**                I2C transfer is busy.
+//**                Not used with the ABPF, it uses the same I/O lines.
+//**
+//** History......: Check the main.c file
+//**
+//**************************************************************************
+
+#include "main.h"
+#include <util/atomic.h>
+
+#if INCLUDE_KEYER
+
+#if defined (__AVR_ATtiny45__) || defined (__AVR_ATtiny85__)
+#define	KEYER_PCICR		GIMSK
+#define	KEYER_PCIE		PCIE
+#define	KEYER_PCMSK		PCMSK
+#define	KEYER_TIMSK		TIMSK
+#elif defined (__AVR_ATmega328P__)
+#define	KEYER_PCICR		PCICR
+#define	KEYER_PCIE		PCIE0
+#define	KEYER_PCMSK		PCMSK0
+#define	KEYER_TIMSK		TIMSK0
+#else
+#error Define correct CPU.
+#endif
+
+#define	KEYER_DIT		_BV(0)
+#define	KEYER_DAH		_BV(1)
+
+static	uint16_t			KeyerDitOn;			// Dit key down time [ms]
+static	uint16_t			KeyerDahOn;			// Dah key down time [ms]
+static	uint16_t			KeyerSpace;			// Key up time after a element [ms]
+static	uint16_t			KeyerTime;			// Time to go of the element or space, 0 is idle
+static	uint8_t				KeyerLast;			// Last element, KEYER_DIT or KEYER_DAH
+static	uint8_t				KeyerLatch;			// Iambic B, other paddle during the element
+static	volatile uint8_t	KeyerKeyDown;		// Key output state
+static	volatile uint16_t	KeyerEdge;			// Tick of the last key change
+
+// Paddle state, the key lines are active low.
+static uint8_t
+KeyerPaddles(void)
+{
+	uint8_t	pin = IO_PIN;
+	uint8_t	paddles = 0;
+
+	if (!(pin & _BV(IO_CW1)))
+		paddles |= KEYER_DIT;
+
+#if defined(DEVICE_SI570) || defined(DEVICE_SI549)
+	if (!I2CActive)
+#endif
+		if (!(pin & _BV(IO_CW2)))
+			paddles |= KEYER_DAH;
+
+	return paddles;
+}
+
+static void
+KeyerSet(uint8_t down)
+{
+	if (down == KeyerKeyDown)
+		return;
+
+	if (down)
+		bit_1(IO_PORT, IO_PTT);
+	else
+		bit_0(IO_PORT, IO_PTT);
+
+	KeyerKeyDown = down;
+	KeyerEdge = TimerGetTicks();
+}
+
+// The keyer, called with the timer and pin change interrupt masked.
+// Tick is true from the millisecond timer, false from a paddle change.
+static void
+KeyerRun(uint8_t tick)
+{
+	uint8_t	paddles = KeyerPaddles();
+	uint8_t	element;
+
+	if (R.KeyerMode == KEYER_STRAIGHT)
+	{
+		KeyerSet(paddles & KEYER_DIT);
+		return;
+	}
+
+	if (KeyerKeyDown && R.KeyerMode == KEYER_IAMBIC_B)
+		KeyerLatch |= paddles & ~KeyerLast;
+
+	if (KeyerTime != 0)
+	{
+		if (!tick || --KeyerTime != 0)
+			return;
+	}
+
+	if (KeyerKeyDown)							// End of the element, now the space
+	{
+		KeyerSet(false);
+		KeyerTime = KeyerSpace;
+		return;
+	}
+
+	element = paddles | KeyerLatch;				// End of the space or idle, next element
+	KeyerLatch = 0;
+
+	if (element == 0)
+		return;
+
+	if (element == (KEYER_DIT | KEYER_DAH))		// Squeeze, the other element
+		element = KeyerLast ^ (KEYER_DIT | KEYER_DAH);
+
+	KeyerLast = element;
+	KeyerTime = element == KEYER_DIT ? KeyerDitOn : KeyerDahOn;
+	KeyerSet(true);
+
+	if (R.KeyerMode == KEYER_IAMBIC_B)			// The other paddle is already down
+		KeyerLatch = paddles & ~element;
+}
+
+// The timer and the pin change interrupt are not blocking (USB), mask
+// both while the keyer runs. A keyer interrupt within an other one finds
+// them masked and leaves them masked, only the first one unmasks.
+static void
+KeyerLock(uint8_t tick)
+{
+	uint8_t		pcie;
+	uint8_t		ocie;
+
+	ATOMIC_BLOCK(ATOMIC_FORCEON)
+	{
+		pcie = KEYER_PCICR & _BV(KEYER_PCIE);
+		ocie = KEYER_TIMSK & _BV(OCIE0A);
+		KEYER_PCICR &= ~_BV(KEYER_PCIE);
+		KEYER_TIMSK &= ~_BV(OCIE0A);
+	}
+
+	if (pcie && ocie)
+		KeyerRun(tick);
+
+	ATOMIC_BLOCK(ATOMIC_FORCEON)
+	{
+		KEYER_TIMSK |= ocie;
+		KEYER_PCICR |= pcie;
+	}
+}
+
+ISR(PCINT0_vect, ISR_NOBLOCK)
+{
+	KeyerLock(false);
+}
+
+// Called by the Timer0 interrupt every millisecond.
+void
+KeyerTick(void)
+{
+	if (KEYER_PCMSK != 0)
+		KeyerLock(true);
+}
+
+// Use the keyer settings of R, correct the values out of range.
+void
+KeyerInit(void)
+{
+	uint16_t	dit;
+
+	KEYER_PCMSK = 0;
+
+	if (R.KeyerMode > KEYER_IAMBIC_B)
+		R.KeyerMode = KEYER_OFF;
+	if (R.KeyerWpm < KEYER_WPM_MIN || R.KeyerWpm > KEYER_WPM_MAX)
+		R.KeyerWpm = KEYER_WPM_DEFAULT;
+	if (R.KeyerWeight < KEYER_WEIGHT_MIN || R.KeyerWeight > KEYER_WEIGHT_MAX)
+		R.KeyerWeight = KEYER_WEIGHT_DEFAULT;
+
+	// PARIS timing, a dit is 1200/WPM ms. The weight 50 is a 1:1 dit and space,
+	// a heavier weight makes the element longer and the space shorter.
+	dit = 1200 / R.KeyerWpm;
+	KeyerDitOn = dit * R.KeyerWeight / 50;
+	KeyerDahOn = 2 * dit + KeyerDitOn;
+	KeyerSpace = 2 * dit - KeyerDitOn;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		KeyerTime  = 0;
+		KeyerLatch = 0;
+		KeyerSet(false);
+	}
+
+	if (R.KeyerMode != KEYER_OFF && !(R.ConfigFlags & CONFIG_ABPF))
+	{
+		KEYER_PCMSK = _BV(IO_CW1) | _BV(IO_CW2);
+		KEYER_PCICR |= _BV(KEYER_PCIE);
+	}
+}
+
+// Return the key state and the tick of the last change.
+uint8_t
+KeyerGetState(uint16_t* tick)
+{
+	uint8_t	down;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		down  = KeyerKeyDown;
+		*tick = KeyerEdge;
+	}
+	return down;
+}
+
+#endif
@@ -0,0 +1,79 @@
+//************************************************************************
+//**
+//** Project......: Firmware USB AVR Si570 controler.
+//**
+//** Platform.....: ATtiny45
+//**
+//** Licence......: This software is freely available for non-commercial
+//**                use - i.e. for research and experimentation only!
+//**
+//** Programmer...: F.W. Krom, PE0FKO
+//**
+//** Description..: Profile counters, the last, minimal and maximal time of
+//**                SetFreq, SetFreqDevice, a I2C transaction, a eeprom
+//**                write and the main loop period.
+//**                The time is in Timer0 counts of 256 CPU cycles.
+//**                Only for the development, INCLUDE_PROFILE.
+//**
+//** History......: Check the main.c file
+//**
+//**************************************************************************
+
+#include "main.h"
+
+#if INCLUDE_PROFILE
+
+typedef struct {
+	uint16_t	last;
+	uint16_t	min;
+	uint16_t	max;
+} profile_t;
+
+static	profile_t	ProfileData[PROFILE_COUNT];
+static	uint16_t	ProfileLoopTime;			// Start of the main loop
+
+void
+ProfileReset(void)
+{
+	uint8_t	i;
+
+	for (i = 0; i < PROFILE_COUNT; ++i)
+	{
+		ProfileData[i].last = 0;
+		ProfileData[i].min  = 0xFFFF;
+		ProfileData[i].max  = 0;
+	}
+	ProfileLoopTime = TimerGetCounts();
+}
+
+// Add the time from start until now to the counter n.
+void
+ProfileAdd(uint8_t n, uint16_t start)
+{
+	profile_t*	p = &ProfileData[n];
+	uint16_t	t = TimerGetCounts() - start;
+
+	p->last = t;
+	if (t < p->min) p->min = t;
+	if (t > p->max) p->max = t;
+}
+
+// Called at the start of the main loop.
+void
+ProfileLoop(void)
+{
+	uint16_t	start = ProfileLoopTime;
+
+	ProfileLoopTime = TimerGetCounts();
+	ProfileAdd(PROFILE_LOOP, start);
+}
+
+// Reply the counters, last, min and max of every counter.
+uint8_t
+ProfileGet(void)
+{
+	usbMsgPtr = (uint8_t*)ProfileData;
+	return sizeof(ProfileData);
+}
+
+#endif
@@ -0,0 +1,63 @@
+//************************************************************************
+//**
+//** Project......: Firmware USB AVR Si570 controler.
+//**
+//** Description..: Si570 divider table, generated by Si570DivTableGen.c
+//**                Do not edit, build it again after changing the search
+//**                loop Si570SearchDivider() in DeviceSi570.c.
+//**
+//** History......: Check the main.c file
+//**
+//**************************************************************************
+
+#define	SI570_DIV_SMALL_N0		18			// Below this N0 the table is by chip grade
+#define	SI570_DIV_RUN_HS_SHIFT	11			// Run: HS_DIV << 11 | first N0
+#define	SI570_DIV_RUN_N0		0x07FF
+
+// HS_DIV << 4 | N1, zero is no divider possible.
+static const uint8_t Si570DivSmall[CHIP_GRADE_D - CHIP_GRADE_A + 1][SI570_DIV_SMALL_N0] PROGMEM =
+{
+	{ 0x41,0x41,0x41,0x41,0x51,0x61,0x71,0x42,0x91,0x52,0xB1,0x62,0x72,0x72,0x44,0x44,0x92,0x92 },	// Grade A
+	{ 0x61,0x61,0x61,0x61,0x61,0x61,0x71,0x42,0x91,0x52,0xB1,0x62,0x72,0x72,0x44,0x44,0x92,0x92 },	// Grade B
+	{ 0x91,0x91,0x91,0x91,0x91,0x91,0x91,0x91,0x91,0x00,0x54,0x54,0x54,0x54,0x54,0x54,0x54,0x54 },	// Grade C
+	{ 0x91,0x91,0x91,0x91,0x91,0x91,0x91,0x91,0x91,0x44,0x44,0x44,0x44,0x44,0x44,0x44,0x54,0x54 },	// Grade D
+};
+
+// Runs of N0 with the same HS_DIV, zero HS_DIV is no divider possible.
+static const uint16_t Si570DivRuns[] PROGMEM =
+{
+	0x2812, 0x5814, 0x3016, 0x3818, 0x281C, 0x201E, 0x4820, 0x2824,
+	0x3828, 0x582A, 0x302C, 0x2830, 0x4832, 0x3836, 0x3038, 0x203C,
+	0x5840, 0x3842, 0x4846, 0x2848, 0x3850, 0x5854, 0x4858, 0x305A,
+	0x3860, 0x2862, 0x2064, 0x4868, 0x586C, 0x386E, 0x3070, 0x4878,
+	0x207E, 0x2880, 0x5882, 0x2084, 0x3888, 0x488C, 0x2890, 0x2096,
+	0x5898, 0x309A, 0x289C, 0x48A0, 0x38A2, 0x28A8, 0x58AA, 0x48B0,
+	0x38B4, 0x20B6, 0x28B8, 0x30BE, 0x38C0, 0x58C4, 0x28C6, 0x30C8,
+	0x20CC, 0x38D0, 0x48D2, 0x58D8, 0x38DC, 0x30E0, 0x28E4, 0x20E6,
+	0x48E8, 0x38EA, 0x30EE, 0x58F0, 0x20F2, 0x28F8, 0x48FA, 0x20FC,
+	0x2900, 0x5904, 0x3908, 0x490A, 0x210E, 0x3110, 0x3914, 0x5918,
+	0x491E, 0x2920, 0x3922, 0x2126, 0x3128, 0x212C, 0x4930, 0x5932,
+	0x2934, 0x3136, 0x2938, 0x3940, 0x4942, 0x2144, 0x5948, 0x394A,
+	0x2950, 0x4954, 0x2156, 0x3158, 0x395C, 0x595E, 0x4960, 0x3968,
+	0x216C, 0x2970, 0x3172, 0x5974, 0x2176, 0x4978, 0x297A, 0x317C,
+	0x2980, 0x3986, 0x5988, 0x298C, 0x3990, 0x3196, 0x2998, 0x499A,
+	0x219E, 0x59A0, 0x39A2, 0x21A4, 0x29A8, 0x49AE, 0x39B0, 0x59B2,
+	0x31B8, 0x39BC, 0x49C0, 0x31C2, 0x29C8, 0x59CC, 0x21CE, 0x49D0,
+	0x29D4, 0x21D6, 0x39D8, 0x31DC, 0x59E0, 0x49E4, 0x21E6, 0x39E8,
+	0x31EA, 0x21EC, 0x29F0, 0x49F4, 0x59F8, 0x29FA, 0x21FE, 0x3200,
+	0x3A04, 0x2A06, 0x4A08, 0x5A0A, 0x2A10, 0x3A12, 0x4A14, 0x3A1C,
+	0x5A22, 0x3226, 0x4A28, 0x3A2E, 0x3230, 0x2A34, 0x5A3A, 0x3A3C,
+	0x4A3E, 0x2A40, 0x3A44, 0x2A4C, 0x5A4E, 0x3252, 0x3A58, 0x2A5A,
+	0x4A62, 0x5A64, 0x2A68, 0x326C, 0x4A70, 0x3276, 0x5A7C, 0x2A7E,
+	0x3A80, 0x4A84, 0x3A88, 0x5A92, 0x4A94, 0x3A9A, 0x5AA0, 0x4AAA,
+	0x3AAC, 0x32AE, 0x3AB8, 0x4ABC, 0x5ABE, 0x32C0, 0x3AC4, 0x4ACA,
+	0x5AD0, 0x3AD6, 0x32D8, 0x4ADC, 0x3AE2, 0x32E6, 0x5AE8, 0x4AEC,
+	0x32F4, 0x5B00, 0x4B02, 0x3B06, 0x5B10, 0x3B18, 0x4B1E, 0x3B2A,
+	0x5B2C, 0x3B2E, 0x4B3A, 0x5B3C, 0x3B44, 0x4B48, 0x3B4E, 0x5B56,
+	0x4B5A, 0x3B60, 0x5B64, 0x4B70, 0x3B72, 0x4B80, 0x5B84, 0x4B86,
+	0x5B96, 0x4B9C, 0x5BA8, 0x4BB2, 0x5BBA, 0x4BC8, 0x5BCC, 0x4BDE,
+	0x5BF0, 0x4BF4, 0x5C02, 0x4C0A, 0x5C14, 0x4C20, 0x5C26, 0x4C36,
+	0x5C4A, 0x4C4C, 0x5C5C, 0x4C62, 0x5C6E, 0x4C78, 0x5C80, 0x056A
+};
+
+#define	SI570_DIV_RUNS			(sizeof(Si570DivRuns)/sizeof(Si570DivRuns[0]))
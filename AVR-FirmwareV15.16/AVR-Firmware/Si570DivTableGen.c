@@ -0,0 +1,182 @@
+//************************************************************************
+//**
+//** Project......: Firmware USB AVR Si570 controler.
+//**
+//** Platform.....: Host PC (gcc), not the AVR chip
+//**
+//** Licence......: This software is freely available for non-commercial
+//**                use - i.e. for research and experimentation only!
+//**
+//** Programmer...: F.W. Krom, PE0FKO
+//**
+//** Description..: Build the Si570 divider table Si570DivTable.h from the
+//**                divider search loop in DeviceSi570.c, and check the table
+//**                against the search for all N0 values and chip grades.
+//**                Build:
+//**                  gcc -std=gnu99 -funsigned-char -fpack-struct -I. -o Si570DivTableGen Si570DivTableGen.c
+//**                Use:
+//**                  Si570DivTableGen > Si570DivTable.h
+//**                  Si570DivTableGen -c
+//**
+//** History......: Check the main.c file
+//**
+//**************************************************************************
+
+#define	DEVICE_SI570
+#define	SI570_DIV_TABLE_GEN
+
+#include <stdio.h>
+#include "DeviceSi570.c"
+#include "CalcVFO.c"
+#include "I2CQueue.c"
+
+volatile uint8_t	DDRB, PORTB, PINB;
+uint8_t				I2CErrors;
+
+void	I2CSendStart(void)			{ }
+void	I2CSendStop(void)			{ }
+void	I2CSendByte(uint8_t b)		{ (void)b; }
+void	I2CSend0(void)				{ }
+void	I2CSend1(void)				{ }
+uint8_t	I2CReceiveByte(void)		{ return 0; }
+
+uint8_t	eeprom_read_byte(const uint8_t* addr)						{ (void)addr; return 0xFF; }
+void	eeprom_read_block(void* dst, const void* src, size_t n)		{ (void)src; memset(dst, 0xFF, n); }
+void	eeprom_write_byte(uint8_t* addr, uint8_t value)				{ (void)addr; (void)value; }
+void	eeprom_write_word(uint16_t* addr, uint16_t value)			{ (void)addr; (void)value; }
+void	eeprom_write_block(const void* src, void* dst, size_t n)	{ (void)src; (void)dst; (void)n; }
+
+#if INCLUDE_INTERRUPT
+uint32_t			EventFreq;
+#endif
+#if INCLUDE_TEMP_COMP
+uint32_t	TempCompFreq(uint32_t freq)	{ return freq; }
+#endif
+
+#define	SMALL_N0		18			// Below this N0 the grade changes the dividers
+
+// HS_DIV found by the search loop, 0 is no divider possible
+static uint8_t
+SearchHS(uint8_t grade, uint16_t N0)
+{
+	R.SiChipGrade = grade;
+	return Si570SearchDivider(N0) ? Si570_HS_DIV : 0;
+}
+
+static int
+Generate(void)
+{
+	uint16_t	N0;
+	uint8_t		grade;
+	uint8_t		hs, last = 0xFF;
+	int			runs = 0;
+
+	printf("//************************************************************************\r\n");
+	printf("//**\r\n");
+	printf("//** Project......: Firmware USB AVR Si570 controler.\r\n");
+	printf("//**\r\n");
+	printf("//** Description..: Si570 divider table, generated by Si570DivTableGen.c\r\n");
+	printf("//**                Do not edit, build it again after changing the search\r\n");
+	printf("//**                loop Si570SearchDivider() in DeviceSi570.c.\r\n");
+	printf("//**\r\n");
+	printf("//** History......: Check the main.c file\r\n");
+	printf("//**\r\n");
+	printf("//**************************************************************************\r\n");
+	printf("\r\n");
+	printf("#define\tSI570_DIV_SMALL_N0\t\t%d\t\t\t// Below this N0 the table is by chip grade\r\n", SMALL_N0);
+	printf("#define\tSI570_DIV_RUN_HS_SHIFT\t11\t\t\t// Run: HS_DIV << 11 | first N0\r\n");
+	printf("#define\tSI570_DIV_RUN_N0\t\t0x07FF\r\n");
+	printf("\r\n");
+
+	printf("// HS_DIV << 4 | N1, zero is no divider possible.\r\n");
+	printf("static const uint8_t Si570DivSmall[CHIP_GRADE_D - CHIP_GRADE_A + 1][SI570_DIV_SMALL_N0] PROGMEM =\r\n");
+	printf("{\r\n");
+	for (grade = CHIP_GRADE_A; grade <= CHIP_GRADE_D; ++grade)
+	{
+		printf("\t{");
+		for (N0 = 0; N0 < SMALL_N0; ++N0)
+		{
+			uint8_t x = 0;
+			R.SiChipGrade = grade;
+			if (Si570SearchDivider(N0))
+				x = Si570_HS_DIV << 4 | Si570_N1;
+			printf("%s0x%02X", N0 ? "," : " ", x);
+		}
+		printf(" },\t// Grade %c\r\n", 'A' + grade - CHIP_GRADE_A);
+	}
+	printf("};\r\n");
+	printf("\r\n");
+
+	printf("// Runs of N0 with the same HS_DIV, zero HS_DIV is no divider possible.\r\n");
+	printf("static const uint16_t Si570DivRuns[] PROGMEM =\r\n");
+	printf("{");
+	for (N0 = SMALL_N0; ; ++N0)
+	{
+		hs = SearchHS(CHIP_GRADE_A, N0);
+		if (hs != last)
+		{
+			if (N0 > 0x07FF)
+			{
+				fprintf(stderr, "N0 %u does not fit in a run\n", N0);
+				return 1;
+			}
+			printf("%s0x%04X", runs == 0 ? "\r\n\t" : runs % 8 ? ", " : ",\r\n\t", hs << 11 | N0);
+			last = hs;
+			++runs;
+		}
+		if (N0 == 0xFFFF)
+			break;
+	}
+	printf("\r\n};\r\n");
+	printf("\r\n");
+	printf("#define\tSI570_DIV_RUNS\t\t\t(sizeof(Si570DivRuns)/sizeof(Si570DivRuns[0]))\r\n");
+
+	return 0;
+}
+
+static int
+Check(void)
+{
+	uint32_t	N0;
+	uint8_t		grade;
+	long		errors = 0;
+
+	for (grade = 0; grade <= CHIP_GRADE_D + 1; ++grade)
+	{
+		for (N0 = 0; N0 <= 0xFFFF; ++N0)
+		{
+			uint8_t		sOk, tOk;
+			uint16_t	sN;
+			uint8_t		sN1, sHS;
+
+			R.SiChipGrade = grade;
+			Si570_N = 0; Si570_N1 = 0; Si570_HS_DIV = 0;
+			sOk = Si570SearchDivider(N0);
+			sN = Si570_N; sN1 = Si570_N1; sHS = Si570_HS_DIV;
+
+			Si570_N = 0; Si570_N1 = 0; Si570_HS_DIV = 0;
+			tOk = Si570TableDivider(N0);
+
+			if (sOk != tOk
+			||	(sOk && (sN != Si570_N || sN1 != Si570_N1 || sHS != Si570_HS_DIV)))
+			{
+				if (errors < 10)
+					printf("Grade %u N0 %lu: search %u %u*%u table %u %u*%u\n",
+						grade, (unsigned long)N0, sOk, sHS, sN1, tOk, Si570_HS_DIV, Si570_N1);
+				++errors;
+			}
+		}
+	}
+
+	printf("%ld differences\n", errors);
+	return errors != 0;
+}
+
+int
+main(int argc, char** argv)
+{
+	if (argc > 1 && strcmp(argv[1], "-c") == 0)
+		return Check();
+
+	return Generate();
+}
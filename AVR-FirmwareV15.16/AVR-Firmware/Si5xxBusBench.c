@@ -0,0 +1,676 @@
+//************************************************************************
+//**
+//** Project......: Firmware USB AVR Si570 controler.
+//**
+//** Platform.....: Host PC (gcc), not the AVR chip
+//**
+//** Licence......: This software is freely available for non-commercial
+//**                use - i.e. for research and experimentation only!
+//**
+//** Programmer...: F.W. Krom, PE0FKO
+//**
+//** Description..: Test bench of the device code with a model of the chip
+//**                on the bit-banged SDA / SCL pins. The firmware code
+//**                SetFreq(), DeviceSi570.c / DeviceSi549.c, I2CQueue.c and
+//**                I2Copencollector.c runs as on the AVR, every _delay_us()
+//**                of it samples the pins (HOST_DELAY_US of HostAvr.h). The
+//**                model decodes the I2C transactions into the chip registers
+//**                and follows the output frequency like the chip:
+//**                Si570: reg 7..12 (RFREQ index 7), 13..18, 135 (RECALL,
+//**                  FreezeM, NewFreq), 137 (FreezeDCO).
+//**                Si549: page reg 255, reg 7 (FCAL), 17 (output enable),
+//**                  23..31, 69, 231..233 (ADPLL_DELTA_M).
+//**                After every SetFreq() the output of the model is checked
+//**                against the asked frequency. A chip error is a write
+//**                sequence the chip does not do as the firmware expects,
+//**                like a RFREQ write while NewFreq is set or a DCO out of
+//**                the range. The bus time is the sum of the delays of the
+//**                I2C code, it is the tune time of a command on the AVR
+//**                without the cycles of the math (FreqMathBench.c).
+//**                Runs: online (power up), sweep 10 - 280 MHz 100 kHz steps,
+//**                tune 14.000 - 14.350 MHz and back in 100 Hz steps, 1000
+//**                jumps in 10 - 280 MHz. Exit code 1 on a error, the known
+//**                errors are in NewFunc.txt.
+//**                Build:
+//**                  gcc -std=gnu99 -funsigned-char -fpack-struct -I. -DDEVICE_SI570 -o Si570BusBench Si5xxBusBench.c -lm
+//**                  gcc -std=gnu99 -funsigned-char -fpack-struct -I. -DDEVICE_SI549 -o Si549BusBench Si5xxBusBench.c -lm
+//**                  -D__AVR_ATmega328P__ for the ATmega pins and the image cache.
+//**                Use:
+//**                  Si570BusBench [max error Hz]		Default 1 Hz
+//**
+//** History......: Check the main.c file
+//**
+//**************************************************************************
+
+#if !defined(DEVICE_SI570) && !defined(DEVICE_SI549)
+#define	DEVICE_SI570
+#endif
+
+#define	HOST_DELAY_US	BusDelay		// The firmware delays follow the pins
+static	void	BusDelay(double us);
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#if defined(DEVICE_SI570)
+#include "DeviceSi570.c"
+#else
+#include "DeviceSi549.c"
+#endif
+#include "CalcVFO.c"
+#include "I2CQueue.c"
+#include "I2Copencollector.c"
+#if INCLUDE_IMAGE_CACHE
+#include "ImageCache.c"
+#endif
+
+volatile uint8_t	DDRB, PORTB, PINB;
+
+uint8_t	eeprom_read_byte(const uint8_t* addr)						{ (void)addr; return 0xFF; }
+void	eeprom_read_block(void* dst, const void* src, size_t n)		{ (void)src; memset(dst, 0xFF, n); }
+void	eeprom_write_byte(uint8_t* addr, uint8_t value)				{ (void)addr; (void)value; }
+void	eeprom_write_word(uint16_t* addr, uint16_t value)			{ (void)addr; (void)value; }
+void	eeprom_write_block(const void* src, void* dst, size_t n)	{ (void)src; (void)dst; (void)n; }
+
+#if INCLUDE_INTERRUPT
+uint32_t			EventFreq;
+#endif
+#if INCLUDE_TEMP_COMP
+uint32_t	TempCompFreq(uint32_t freq)	{ return freq; }
+#endif
+
+#define	CHIP_ADDR		0x55			// I2C address of the model, R.ChipCrtlData
+#define	PRINT_ERRORS	5				// Errors printed of a run
+#define	DCO_ROUND		1e-6			// Rounding of the DCO limit compare [MHz]
+
+#define	SWEEP_START		((uint32_t)( 10.0 * _2(21)))
+#define	SWEEP_STOP		((uint32_t)(280.0 * _2(21)))	// Grade C range of both chips
+#define	SWEEP_STEP		((uint32_t)(  0.1 * _2(21)))
+#define	TUNE_START		((uint32_t)(14.0  * _2(21)))
+#define	TUNE_STOP		((uint32_t)(14.35 * _2(21)))
+#define	TUNE_STEP		((uint32_t)(0.0001 * _2(21)))
+#define	JUMPS			1000
+#define	CMD_GAP_US		1000.0			// Time between two USB commands, one frame
+
+//-------------------------------------------------------------------------
+//---- I2C bus, decoded from the pin changes
+//-------------------------------------------------------------------------
+
+enum { BUS_IDLE, BUS_ADDR, BUS_REG, BUS_WRITE, BUS_READ };
+
+static struct {
+	uint8_t		state;					// Part of the transaction
+	uint8_t		bit;					// Clock of the byte, 8 the acknowledge, 9 after it
+	uint8_t		shift;					// Byte in from the master
+	uint8_t		out;					// Byte out to the master
+	uint8_t		reg;					// Register pointer of the chip
+	uint8_t		sent;					// The byte is from the chip
+	uint8_t		scl;					// Line levels of the last sample
+	uint8_t		sda;
+	uint8_t		chipSda;				// SDA of the chip, 0 pulls the line low
+	double		time;					// Bus time [us]
+	long		bytes;					// Bytes on the bus, device address included
+	long		trans;					// Transactions, stop conditions
+} Bus;
+
+static	uint8_t		Written[256];		// Registers written in the transaction
+
+static	void		ChipWrite(uint8_t reg, uint8_t data);
+static	uint8_t		ChipRead(uint8_t reg);
+static	void		ChipStop(void);
+
+// The SDA line, the master and the chip pull it low.
+static uint8_t
+BusSda(void)
+{
+	return !(DDRB & _BV(BIT_SDA)) && Bus.chipSda;
+}
+
+// Rising clock, the receiver takes the bit.
+static void
+BusRise(void)
+{
+	if (Bus.state == BUS_IDLE)
+		return;
+
+	if (Bus.bit < 8)
+	{
+		Bus.shift = (Bus.shift << 1) | BusSda();
+		Bus.bit++;
+		return;
+	}
+
+	if (Bus.bit == 8 && Bus.sent)		// Acknowledge of the master
+	{
+		Bus.bytes++;
+		Bus.reg++;
+		if (BusSda())					// Not acknowledge of the master, last byte
+			Bus.state = BUS_IDLE;
+	}
+	Bus.bit = 9;
+}
+
+// A byte from the master, return true when the chip acknowledges it.
+static uint8_t
+BusByte(uint8_t b)
+{
+	Bus.bytes++;
+
+	switch (Bus.state) {
+		case BUS_ADDR:
+			if ((b >> 1) != CHIP_ADDR)
+			{
+				Bus.state = BUS_IDLE;
+				return false;
+			}
+			Bus.state = (b & 1) ? BUS_READ : BUS_REG;
+			break;
+		case BUS_REG:
+			Bus.reg   = b;
+			Bus.state = BUS_WRITE;
+			break;
+		case BUS_WRITE:
+			Written[Bus.reg] = true;
+			ChipWrite(Bus.reg++, b);
+			break;
+	}
+	return true;
+}
+
+// Falling clock, the transmitter sets the next bit.
+static void
+BusFall(void)
+{
+	Bus.chipSda = 1;
+
+	if (Bus.state == BUS_IDLE)
+		return;
+
+	if (Bus.bit == 8)					// Acknowledge clock
+	{
+		if (Bus.state != BUS_READ && BusByte(Bus.shift))
+			Bus.chipSda = 0;
+		return;
+	}
+
+	if (Bus.bit == 9)					// Next byte
+	{
+		Bus.bit = 0;
+		if (Bus.state == BUS_READ)
+		{
+			Bus.out  = ChipRead(Bus.reg);
+			Bus.sent = true;
+		}
+	}
+
+	if (Bus.state == BUS_READ)
+		Bus.chipSda = (Bus.out >> (7 - Bus.bit)) & 1;
+}
+
+// The pins are sampled by every firmware delay, the master changes
+// one line before a delay. The chip does not stretch the clock.
+static void
+BusDelay(double us)
+{
+	uint8_t		scl = !(DDRB & _BV(BIT_SCL));
+	uint8_t		sda;
+
+	Bus.time += us;
+
+	if (scl != Bus.scl)
+	{
+		Bus.scl = scl;
+		if (scl)
+			BusRise();
+		else
+			BusFall();
+	}
+	else
+	if (scl && BusSda() != Bus.sda)
+	{
+		if (!BusSda())					// Start, SDA low while SCL high
+		{
+			Bus.state	= BUS_ADDR;
+			Bus.bit		= 0;
+			Bus.sent	= false;
+			memset(Written, 0, sizeof(Written));
+		}
+		else							// Stop, SDA high while SCL high
+		{
+			Bus.state	= BUS_IDLE;
+			Bus.trans++;
+			ChipStop();
+		}
+	}
+
+	sda = BusSda();
+	Bus.sda = sda;
+	PINB = _BV(BIT_SCL) | (sda ? _BV(BIT_SDA) : 0);
+}
+
+//-------------------------------------------------------------------------
+//---- Chip models
+//-------------------------------------------------------------------------
+
+static	uint8_t		Reg[256];			// Registers of the chip (page 0)
+static	uint8_t		Pending;			// Registers written, not yet used by the chip
+static	double		ChipFout;			// Output frequency [MHz], 0 output off
+static	long		ChipErrors;			// Errors of the run
+static	long		LargeChanges;		// Of the run
+static	long		SmallChanges;
+static	uint32_t	Asked;				// Frequency of the SetFreq() call [11.21]
+
+// Frequency [11.21] in MHz
+static double
+MHz(uint32_t freq)
+{
+	return (double)freq / _2(21);
+}
+
+static double
+XtalMHz(void)
+{
+	return (double)R.FreqXtal / _2(24);		// The model xtal is the calibrated one
+}
+
+static void
+ChipError(const char* text, double value)
+{
+	if (++ChipErrors <= PRINT_ERRORS)
+		printf("    chip error: %s (%.6f) at %.6f MHz\n", text, value, MHz(Asked));
+}
+
+#if defined(DEVICE_SI570)
+
+#define	SI570_NEW_FREQ_US	250.0		// NewFreq set time of the model
+#define	SI570_PPM			3500		// Smooth tune limit of the datasheet
+
+static	uint8_t		Run[6];				// Registers 7..12 of the output
+static	double		RunCenter;			// RFREQ of the last NewFreq
+static	double		NewFreqClear;		// Bus time the NewFreq bit clears
+
+static uint16_t
+Si570N(const uint8_t* r)
+{
+	uint8_t	hs = (r[0] >> 5) + 4;
+	uint8_t	n1 = (((r[0] & 0x1F) << 2) | (r[1] >> 6)) + 1;
+
+	if (hs == 8 || hs == 10 || hs > 11 || (n1 != 1 && (n1 & 1)))
+		return 0;
+	return hs * n1;
+}
+
+static double
+Si570RFREQ(const uint8_t* r)
+{
+	uint64_t	rfreq = ((uint64_t)(r[1] & 0x3F) << 32)
+					  | ((uint32_t)r[2] << 24) | ((uint32_t)r[3] << 16) | (r[4] << 8) | r[5];
+
+	return (double)rfreq / _2(28);
+}
+
+// The chip uses the registers 7..12 for the output.
+static void
+Si570Apply(void)
+{
+	uint16_t	n = Si570N(Reg + 7);
+	double		dco = XtalMHz() * Si570RFREQ(Reg + 7);
+
+	memcpy(Run, Reg + 7, sizeof(Run));
+	if (n == 0)
+	{
+		ChipError("HS_DIV / N1 not valid", Reg[7]);
+		ChipFout = 0;
+		return;
+	}
+	if (dco < Chip_DCO_Min - DCO_ROUND || dco > Chip_DCO_Max + DCO_ROUND)
+		ChipError("DCO out of range [MHz]", dco);
+	ChipFout = dco / n;
+}
+
+static void
+ChipReset(void)
+{
+	static const uint8_t	signature[] = { 0x07, 0xC2, 0xC0, 0x00, 0x00, 0x00 };
+	uint64_t	rfreq = (uint64_t)llround(5000.0 / XtalMHz() * _2(28));
+
+	// Factory startup 100 MHz, DCO 5000 MHz, HS_DIV 5, N1 10
+	memset(Reg, 0, sizeof(Reg));
+	Reg[7]	= ((5 - 4) << 5) | ((10 - 1) >> 2);
+	Reg[8]	= ((10 - 1) & 0x03) << 6 | (uint8_t)(rfreq >> 32);
+	Reg[9]	= rfreq >> 24;
+	Reg[10]	= rfreq >> 16;
+	Reg[11]	= rfreq >> 8;
+	Reg[12]	= rfreq;
+	memcpy(Reg + 13, signature, sizeof(signature));	// 50 / 20 ppm chip, RFREQ index 7
+	Si570Apply();
+	RunCenter		= Si570RFREQ(Run);
+	Pending			= false;
+	NewFreqClear	= 0;
+}
+
+static void
+ChipWrite(uint8_t reg, uint8_t data)
+{
+	if (reg >= 7 && reg <= 12)
+	{
+		if (Bus.time < NewFreqClear)
+		{
+			ChipError("RFREQ write lost, NewFreq is set", reg);
+			return;
+		}
+		Reg[reg] = data;
+		if (Reg[137] & (1<<4))
+			Pending = true;				// Used by the next NewFreq
+	}
+	else
+	if (reg == 135)
+	{
+		Reg[135] = data & (1<<5);		// Only FreezeM stays set
+		if (data & (1<<0))				// RECALL
+			ChipReset();
+		if (data & (1<<6))				// NewFreq
+		{
+			if (Reg[137] & (1<<4))
+				ChipError("NewFreq with a frozen DCO", data);
+			Si570Apply();
+			RunCenter		= Si570RFREQ(Run);
+			Pending			= false;
+			NewFreqClear	= Bus.time + SI570_NEW_FREQ_US;
+			LargeChanges++;
+		}
+	}
+	else
+	if (reg == 137)
+		Reg[137] = data;
+	else
+		ChipError("write of a register not in the model", reg);
+}
+
+static uint8_t
+ChipRead(uint8_t reg)
+{
+	if (reg == 135)
+		return Reg[135] | (Bus.time < NewFreqClear ? (1<<6) : 0);
+	return Reg[reg];
+}
+
+// The RFREQ registers of a small change are used at the end of the write,
+// not frozen. The divider can only change with NewFreq.
+static void
+ChipStop(void)
+{
+	double		rfreq;
+
+	if ((Reg[135] & (1<<5)) || (Reg[137] & (1<<4)) || memcmp(Run, Reg + 7, sizeof(Run)) == 0)
+		return;
+
+	if (Pending)						// Waits for NewFreq
+		return;
+
+	if (Si570N(Reg + 7) != Si570N(Run))
+		ChipError("divider changed without NewFreq", Reg[7]);
+
+	rfreq = Si570RFREQ(Reg + 7);
+	if (fabs(rfreq - RunCenter) > RunCenter * SI570_PPM / 1e6)
+		ChipError("small change over 3500 PPM [PPM]", (rfreq - RunCenter) / RunCenter * 1e6);
+
+	Si570Apply();
+	SmallChanges++;
+}
+
+#else
+
+#define	SI549_DELTA_PPM		0.0001164	// ADPLL_DELTA_M unit
+#define	SI549_PPM			950			// Smooth tune limit of the datasheet
+
+static	uint8_t		Run[9];				// Registers 23..31 of the output, FCAL
+
+static int32_t
+Si549Delta(void)
+{
+	int32_t	delta = ((uint32_t)Reg[233] << 16) | (Reg[232] << 8) | Reg[231];
+
+	return delta & 0x800000 ? delta - 0x1000000 : delta;
+}
+
+// The output of the divider registers of the last FCAL and ADPLL_DELTA_M.
+static void
+Si549Output(void)
+{
+	uint16_t	hsdiv = Run[0] | ((Run[1] & 0x07) << 8);
+	uint8_t		lsdiv = (Run[1] >> 4) & 0x07;
+	uint64_t	fbdiv = 0;
+	double		dco;
+	int8_t		i;
+
+	for (i = 8; i >= 3; --i)
+		fbdiv = (fbdiv << 8) | Run[i];
+	fbdiv &= ((uint64_t)1 << 43) - 1;
+	dco = XtalMHz() * fbdiv / 4294967296.0;
+
+	if (!(Reg[17] & 1) || hsdiv == 0)
+	{
+		ChipFout = 0;
+		return;
+	}
+	ChipFout = dco / (hsdiv << lsdiv) * (1.0 + Si549Delta() * SI549_DELTA_PPM / 1e6);
+}
+
+static void
+ChipReset(void)
+{
+	memset(Reg, 0, sizeof(Reg));
+	memset(Run, 0, sizeof(Run));
+	Reg[17]	= 1;
+	Pending	= false;
+	Si549Output();
+}
+
+static void
+ChipWrite(uint8_t reg, uint8_t data)
+{
+	if (reg != 255 && Reg[255] != 0)
+	{
+		ChipError("write on page", Reg[255]);
+		return;
+	}
+
+	if ((reg >= 23 && reg <= 24) || (reg >= 26 && reg <= 31))
+	{
+		if (Reg[17] & 1)
+			ChipError("divider write with the output on", reg);
+		Pending = true;
+	}
+	else
+	if (reg == 7 && (data & (1<<3)))	// FCAL, the chip uses the dividers
+	{
+		uint16_t	hsdiv = Reg[23] | ((Reg[24] & 0x07) << 8);
+		uint64_t	fbdiv = 0;
+		double		dco;
+		int8_t		i;
+
+		if (Reg[17] & 1)
+			ChipError("FCAL with the output on", data);
+		if (hsdiv < 5 || hsdiv > 2046 || (((Reg[24] >> 4) & 0x07) == 0 && hsdiv >= 34 && (hsdiv & 1)))
+			ChipError("HSDIV not valid", hsdiv);
+		for (i = 31; i >= 26; --i)
+			fbdiv = (fbdiv << 8) | Reg[i];
+		dco = XtalMHz() * (fbdiv & (((uint64_t)1 << 43) - 1)) / 4294967296.0;
+		if (dco < Chip_DCO_Min - DCO_ROUND || dco > 12511.886114 + DCO_ROUND)
+			ChipError("DCO out of range [MHz]", dco);
+
+		memcpy(Run, Reg + 23, sizeof(Run));
+		Pending = false;
+		LargeChanges++;
+		data &= ~(1<<3);				// Self clearing
+	}
+	else
+	if (reg == 17 && (data & 1) && Pending)
+		ChipError("output on without FCAL", data);
+	else
+	if (!(reg == 7 || reg == 17 || reg == 69 || reg == 255 || (reg >= 231 && reg <= 233)))
+		ChipError("write of a register not in the model", reg);
+
+	Reg[reg] = data;
+	Si549Output();
+}
+
+static uint8_t
+ChipRead(uint8_t reg)
+{
+	return Reg[reg];
+}
+
+// The ADPLL_DELTA_M of a small change is used at the end of the write.
+static void
+ChipStop(void)
+{
+	int32_t		delta;
+
+	if (!Written[231] && !Written[232] && !Written[233])
+		return;
+
+	delta = Si549Delta();
+	if (fabs(delta * SI549_DELTA_PPM) > SI549_PPM)
+		ChipError("ADPLL_DELTA_M over 950 PPM [PPM]", delta * SI549_DELTA_PPM);
+	if (delta != 0)
+		SmallChanges++;
+}
+
+#endif
+
+//-------------------------------------------------------------------------
+//---- Runs
+//-------------------------------------------------------------------------
+
+typedef struct {
+	const char*	name;
+	long		calls;
+	long		freqErrors;				// Output not the asked frequency
+	double		maxError;				// Worst output error [Hz]
+	double		maxBus;					// Longest bus time of a call [us]
+	double		bus;					// Bus time of all calls [us]
+	long		bytes;
+	long		trans;
+} run_t;
+
+static	double		MaxErrorHz = 1.0;
+static	long		Errors;				// Of all runs
+
+static void
+RunStart(run_t* r, const char* name)
+{
+	memset(r, 0, sizeof(*r));
+	r->name			= name;
+	ChipErrors		= 0;
+	LargeChanges	= 0;
+	SmallChanges	= 0;
+}
+
+// One tune command, the main loop sends the I2C queue.
+static void
+RunFreq(run_t* r, uint32_t freq)
+{
+	double		time;
+	long		bytes = Bus.bytes;
+	long		trans = Bus.trans;
+	double		err;
+
+	Bus.time += CMD_GAP_US;
+	time = Bus.time;
+
+	Asked = freq;
+	SetFreq(freq, 0);
+	I2CQueueFlush();
+	if (Pending)
+		ChipError("registers of a large change not used", 0);
+
+	time = Bus.time - time;
+	r->calls++;
+	r->bus	 += time;
+	r->bytes += Bus.bytes - bytes;
+	r->trans += Bus.trans - trans;
+	if (time > r->maxBus)
+		r->maxBus = time;
+
+	err = fabs(ChipFout - MHz(freq)) * 1e6;
+	if (err > r->maxError)
+		r->maxError = err;
+	if (err > MaxErrorHz && ++r->freqErrors <= PRINT_ERRORS)
+		printf("    freq error: output %.6f MHz at %.6f MHz (%.3f Hz)\n", ChipFout, MHz(freq), err);
+}
+
+static void
+RunReport(const run_t* r)
+{
+	long	calls = r->calls ? r->calls : 1;
+
+	printf("  %-7s %6ld calls, %5ld large, %5ld small, %5.1f bytes %4.1f trans %7.1f us (max %7.1f us) a call, max %.3f Hz, %ld freq errors, %ld chip errors\n",
+		r->name, r->calls, LargeChanges, SmallChanges,
+		(double)r->bytes / calls, (double)r->trans / calls, r->bus / calls, r->maxBus,
+		r->maxError, r->freqErrors, ChipErrors);
+
+	Errors += r->freqErrors + ChipErrors;
+}
+
+int
+main(int argc, char** argv)
+{
+	run_t		r;
+	uint32_t	f;
+	uint32_t	seed = 1;
+	double		time;
+	long		i;
+
+	if (argc > 1)
+		MaxErrorHz = atof(argv[1]);
+
+	PINB		= _BV(BIT_SCL) | _BV(BIT_SDA);	// Chip powered, bus free
+	Bus.scl		= 1;
+	Bus.sda		= 1;
+	Bus.chipSda	= 1;
+
+	R.SiChipGrade = CHIP_GRADE_C;
+	ChipReset();
+	DeviceInit();
+
+	printf("I2C %.0f kbit/s, chip address 0x%02X, max error %.3f Hz\n", I2C_KBITRATE, CHIP_ADDR, MaxErrorHz);
+
+	RunStart(&r, "online");
+	Asked = R.Freq;
+	time = Bus.time;
+	DeviceOnline();
+	r.calls = 1;
+	r.bus	= r.maxBus = Bus.time - time;
+	r.bytes	= Bus.bytes;
+	r.trans	= Bus.trans;
+	r.maxError = fabs(ChipFout - MHz(R.Freq)) * 1e6;
+	if (Chip_OffLine)
+		ChipError("chip not online", 0);
+	if (r.maxError > MaxErrorHz)
+		r.freqErrors++;
+	RunReport(&r);
+
+	RunStart(&r, "sweep");
+	for (f = SWEEP_START; f <= SWEEP_STOP; f += SWEEP_STEP)
+		RunFreq(&r, f);
+	RunReport(&r);
+
+	RunStart(&r, "tune");
+	for (f = TUNE_START; f <= TUNE_STOP; f += TUNE_STEP)
+		RunFreq(&r, f);
+	for (f = TUNE_STOP; f >= TUNE_START; f -= TUNE_STEP)
+		RunFreq(&r, f);
+	RunReport(&r);
+
+	RunStart(&r, "jump");
+	for (i = 0; i < JUMPS; ++i)
+	{
+		seed = seed * 1103515245 + 12345;
+		RunFreq(&r, SWEEP_START + (uint32_t)((uint64_t)(SWEEP_STOP - SWEEP_START) * (seed >> 8) >> 24));
+	}
+	RunReport(&r);
+
+	return Errors != 0;
+}
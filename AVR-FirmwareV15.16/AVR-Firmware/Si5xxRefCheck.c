@@ -0,0 +1,441 @@
+//************************************************************************
+//**
+//** Project......: Firmware USB AVR Si570 controler.
+//**
+//** Platform.....: Host PC (gcc), not the AVR chip
+//**
+//** Licence......: This software is freely available for non-commercial
+//**                use - i.e. for research and experimentation only!
+//**
+//** Programmer...: F.W. Krom, PE0FKO
+//**
+//** Description..: Check the register math of DeviceSi570.c / DeviceSi549.c
+//**                against a long double reference model. The frequency range
+//**                of every chip grade is swept, for every function the worst
+//**                output error in Hz and the DCO limit errors are reported.
+//**                The limits are of the datasheet: the maximum of the grade
+//**                (Si570 grade D is C without the 4 * 4 divider) and the
+//**                smooth tune window, not the compares of the firmware.
+//**                Si570: Si570CalcDivider(), Si570CalcRFREQ(), Si570SmallChange()
+//**                Si549: CalculateFrequencyRegisters(), Si549SmallChange()
+//**                The output error is from the requested [11.21] frequency,
+//**                the small change error is from the requested center.
+//**                Build:
+//**                  gcc -std=gnu99 -funsigned-char -fpack-struct -I. -DDEVICE_SI570 -o Si570RefCheck Si5xxRefCheck.c
+//**                  gcc -std=gnu99 -funsigned-char -fpack-struct -I. -DDEVICE_SI549 -o Si549RefCheck Si5xxRefCheck.c
+//**                Use:
+//**                  Si570RefCheck [step kHz]		Default step 10kHz
+//**                  Si549RefCheck [step kHz]
+//**
+//** History......: Check the main.c file
+//**
+//**************************************************************************
+
+#if !defined(DEVICE_SI570) && !defined(DEVICE_SI549)
+#define	DEVICE_SI570
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#if defined(DEVICE_SI570)
+#include "DeviceSi570.c"
+#else
+#include "DeviceSi549.c"
+#endif
+#include "CalcVFO.c"
+#include "I2CQueue.c"
+
+volatile uint8_t	DDRB, PORTB, PINB;
+uint8_t				I2CErrors;
+
+void	I2CSendStart(void)			{ }
+void	I2CSendStop(void)			{ }
+void	I2CSendByte(uint8_t b)		{ (void)b; }
+void	I2CSend0(void)				{ }
+void	I2CSend1(void)				{ }
+uint8_t	I2CReceiveByte(void)		{ return 0; }
+
+uint8_t	eeprom_read_byte(const uint8_t* addr)						{ (void)addr; return 0xFF; }
+void	eeprom_read_block(void* dst, const void* src, size_t n)		{ (void)src; memset(dst, 0xFF, n); }
+void	eeprom_write_byte(uint8_t* addr, uint8_t value)				{ (void)addr; (void)value; }
+void	eeprom_write_word(uint16_t* addr, uint16_t value)			{ (void)addr; (void)value; }
+void	eeprom_write_block(const void* src, void* dst, size_t n)	{ (void)src; (void)dst; (void)n; }
+
+#if INCLUDE_INTERRUPT
+uint32_t			EventFreq;
+#endif
+#if INCLUDE_TEMP_COMP
+uint32_t	TempCompFreq(uint32_t freq)	{ return freq; }
+#endif
+
+#define	CENTER_EVERY	16				// Every 16th sweep frequency is a smooth tune center
+
+#if defined(DEVICE_SI570)
+#define	REF_SMOOTH_PPM	3500			// Datasheet smooth tune limit
+#define	REF_GRADES		4				// Grade A, B, C and D
+#else
+#define	REF_SMOOTH_PPM	950
+#define	REF_GRADES		3				// The Si549 has no grade D
+#endif
+
+typedef	long double		real_t;
+
+typedef struct {
+	const char*	name;
+	long		calls;					// Frequencies checked
+	long		fails;					// The function returned false, a reference result exists
+	long		dcoErrors;				// DCO out of R.SiChipDCOMin .. R.SiChipDCOMax
+	long		divErrors;				// Divider not possible for the chip (grade)
+	long		windowErrors;			// Smooth tune window not the same as the reference
+	real_t		maxError;				// Worst output error [Hz]
+	real_t		maxErrorFreq;			// At this frequency [MHz]
+	real_t		maxDco;					// Worst DCO out of the limits [MHz], 0 none
+} result_t;
+
+// Frequency [11.21] in MHz
+static real_t
+MHz(uint32_t freq)
+{
+	return (real_t)freq / _2(21);
+}
+
+static real_t
+XtalMHz(void)
+{
+	return (real_t)R.FreqXtal / _2(24);
+}
+
+static void
+AddError(result_t* r, real_t fout, uint32_t freq)
+{
+	real_t	err = (fout - MHz(freq)) * 1e6;
+
+	if (err < 0)
+		err = -err;
+	if (err > r->maxError)
+	{
+		r->maxError		= err;
+		r->maxErrorFreq	= MHz(freq);
+	}
+}
+
+static void
+AddDco(result_t* r, real_t dco)
+{
+	if (dco < R.SiChipDCOMin || dco > R.SiChipDCOMax)
+	{
+		real_t	out = dco < R.SiChipDCOMin ? R.SiChipDCOMin - dco : dco - R.SiChipDCOMax;
+
+		r->dcoErrors++;
+		if (out > r->maxDco)
+			r->maxDco = out;
+	}
+}
+
+static void
+Report(const result_t* r)
+{
+	printf("  %-28s %8ld freq, %3ld fail, %3ld div, %3ld window, %3ld DCO (%.3Lf MHz), max %.3Lf Hz at %.6Lf MHz\n",
+		r->name, r->calls, r->fails, r->divErrors, r->windowErrors, r->dcoErrors, r->maxDco,
+		r->maxError, r->maxErrorFreq);
+}
+
+// The DCO errors are only reported, a small change may move the DCO out
+// of the limits of the large change.
+static int
+Errors(const result_t* r)
+{
+	return r->fails != 0 || r->divErrors != 0 || r->windowErrors != 0;
+}
+
+// Window of the reference from the datasheet: a output within +/- PPM of
+// the center is a small change, the closed interval. The PPM is the smaller
+// of R.SmoothTunePPM and the datasheet limit, Si570 3500 PPM (frequency
+// change without a output interrupt), Si549 950 PPM (ADPLL_DELTA_M range).
+static uint8_t
+RefWindow(uint32_t center, uint32_t freq)
+{
+	real_t		dF = (real_t)freq - center;
+	uint16_t	ppm = R.SmoothTunePPM < REF_SMOOTH_PPM ? R.SmoothTunePPM : REF_SMOOTH_PPM;
+
+	if (dF < 0)
+		dF = -dF;
+
+	return dF * 1000000 <= (real_t)center * ppm;
+}
+
+#if defined(DEVICE_SI570)
+
+// The N1 * HS_DIV settings of the datasheet, grade D is C without the 4*4
+static uint8_t
+RefDivider(uint8_t hs, uint8_t n1)
+{
+	if (hs < 4 || hs > 11 || hs == 8 || hs == 10)
+		return false;
+	if (n1 < 1 || n1 > 128 || (n1 != 1 && (n1 & 1)))
+		return false;
+
+	if (R.SiChipGrade != CHIP_GRADE_A && n1 == 1 && (hs == 4 || hs == 5))
+		return false;
+
+	if (R.SiChipGrade == CHIP_GRADE_C || R.SiChipGrade == CHIP_GRADE_D)
+	{
+		if ((n1 == 1 && (hs == 6 || hs == 7 || hs == 11))
+		||	(n1 == 2 && (hs == 4 || hs == 5 || hs == 6 || hs == 7 || hs == 9)))
+			return false;
+		if (R.SiChipGrade == CHIP_GRADE_C && n1 == 4 && hs == 4)
+			return false;
+	}
+
+	return true;
+}
+
+// A divider with the DCO in the limits exists
+static uint8_t
+RefFindDivider(uint32_t freq)
+{
+	uint8_t		hs;
+	uint8_t		n1;
+	real_t		dco;
+
+	for (hs = 4; hs <= 11; ++hs)
+		for (n1 = 1; n1 <= 128; ++n1)
+			if (RefDivider(hs, n1))
+			{
+				dco = MHz(freq) * hs * n1;
+				if (dco >= R.SiChipDCOMin && dco <= R.SiChipDCOMax)
+					return true;
+			}
+
+	return false;
+}
+
+// Datasheet maximum of the grade [11.21], grade D is C without the
+// 4 * 4 divider, the range of C.
+static uint32_t
+RefMaxFreq(void)
+{
+	switch (R.SiChipGrade)
+	{
+		case CHIP_GRADE_A: return CHIP_MaximalOutputFreqeuency_A;
+		case CHIP_GRADE_B: return CHIP_MaximalOutputFreqeuency_B;
+	}
+	return CHIP_MaximalOutputFreqeuency_C;
+}
+
+// Output frequency [MHz] of the Si_Reg_Data registers, the DCO in dco
+static real_t
+RefOutput(real_t* dco, uint8_t* hs, uint8_t* n1)
+{
+	uint64_t	rfreq;
+
+	*hs = (Si_Reg_Data.N1_HS_DIV >> 5) + 4;
+	*n1 = (((Si_Reg_Data.N1_HS_DIV & 0x1F) << 2) | (Si_Reg_Data.N1_RFREQ_37_32 >> 6)) + 1;
+	rfreq = (uint64_t)(Si_Reg_Data.N1_RFREQ_37_32 & 0x3F) << 32
+		  | (uint64_t)Si_Reg_Data.RFREQ_31_24 << 24
+		  | (uint64_t)Si_Reg_Data.RFREQ_23_16 << 16
+		  | (uint64_t)Si_Reg_Data.RFREQ_15_8 << 8
+		  | Si_Reg_Data.RFREQ_7_0;
+
+	*dco = XtalMHz() * rfreq / _2(28);
+	return *dco / (*hs * *n1);
+}
+
+static int
+CheckGrade(uint32_t step)
+{
+	result_t	div		= { .name = "Si570CalcDivider()" };
+	result_t	rfreq	= { .name = "Si570CalcRFREQ()" };
+	result_t	small	= { .name = "Si570SmallChange()" };
+	uint32_t	freq;
+	uint32_t	n = 0;
+	uint8_t		hs, n1;
+	real_t		dco, fout;
+
+	for (freq = R.MinimalOutputFreqeuency; freq <= R.MaximalOutputFreqeuency; freq += step, ++n)
+	{
+		div.calls++;
+		if (!Si570CalcDivider(freq))
+		{
+			if (RefFindDivider(freq))
+				div.fails++;
+			continue;
+		}
+
+		rfreq.calls++;
+		if (!Si570CalcRFREQ(freq, 0))
+		{
+			if (RefFindDivider(freq))
+				rfreq.fails++;
+			continue;
+		}
+
+		fout = RefOutput(&dco, &hs, &n1);
+		if (!RefDivider(hs, n1))
+			div.divErrors++;
+		AddDco(&div, MHz(freq) * hs * n1);
+		AddDco(&rfreq, dco);
+		AddError(&rfreq, fout, freq);
+
+		// Small changes at the window edges of this center, the dividers
+		// of the center are kept.
+		if (n % CENTER_EVERY == 0 && R.SmoothTunePPM != 0)
+		{
+			uint32_t	bound = (uint32_t)((real_t)freq * R.SmoothTunePPM / 1000000);
+			uint32_t	f[4] = { freq - bound, freq + bound, freq - bound - 1, freq + bound + 1 };
+			uint8_t		i;
+
+			FreqSmoothTune = freq;
+			for (i = 0; i < 4; ++i)
+			{
+				small.calls++;
+				if (Si570SmallChange(f[i]) != RefWindow(freq, f[i]))
+					small.windowErrors++;
+				if (!Si570SmallChange(f[i]))
+					continue;
+
+				if (!Si570CalcRFREQ(f[i], 0))
+				{
+					small.fails++;
+					AddDco(&small, MHz(f[i]) * Si570_N);
+					continue;
+				}
+				fout = RefOutput(&dco, &hs, &n1);
+				AddDco(&small, dco);
+				AddError(&small, fout, f[i]);
+			}
+		}
+	}
+
+	Report(&div);
+	Report(&rfreq);
+	Report(&small);
+
+	return Errors(&div) || Errors(&rfreq) || Errors(&small);
+}
+
+#else
+
+// Datasheet maximum of the grade [11.21]
+static uint32_t
+RefMaxFreq(void)
+{
+	switch (R.SiChipGrade)
+	{
+		case CHIP_GRADE_B: return CHIP_MaximalOutputFreqeuency_B;
+		case CHIP_GRADE_C: return CHIP_MaximalOutputFreqeuency_C;
+	}
+	return CHIP_MaximalOutputFreqeuency_A;
+}
+
+// Output frequency [MHz] of the Si_Reg_Data registers, the DCO in dco
+static real_t
+RefOutput(real_t* dco, uint16_t* hsdiv, uint8_t* lsdiv)
+{
+	uint64_t	fbdiv;
+
+	*hsdiv = Si_Reg_Data.HSDIV_7_0 | (Si_Reg_Data.LSDIV_2_0_HSDIV_10_8 & 0x07) << 8;
+	*lsdiv = Si_Reg_Data.LSDIV_2_0_HSDIV_10_8 >> 4;
+	fbdiv = (uint64_t)(Si_Reg_Data.FBDIV_42_40 & 0x07) << 40
+		  | (uint64_t)Si_Reg_Data.FBDIV_39_32 << 32
+		  | (uint64_t)Si_Reg_Data.FBDIV_31_24 << 24
+		  | (uint64_t)Si_Reg_Data.FBDIV_23_16 << 16
+		  | (uint64_t)Si_Reg_Data.FBDIV_15_8 << 8
+		  | Si_Reg_Data.FBDIV_7_0;
+
+	*dco = XtalMHz() * fbdiv / ((uint64_t)1 << 32);
+	return *dco / ((uint32_t)*hsdiv << *lsdiv);
+}
+
+// ADPLL_DELTA_M, 0.0001164 PPM a step
+static real_t
+RefDeltaPPM(void)
+{
+	int32_t		m = (int32_t)((uint32_t)Si_Reg_Data.ADPLL_DELTA_M_23_16 << 24
+						| (uint32_t)Si_Reg_Data.ADPLL_DELTA_M_15_8 << 16
+						| (uint32_t)Si_Reg_Data.ADPLL_DELTA_M_7_0 << 8) >> 8;
+
+	return m * (real_t)0.0001164;
+}
+
+static int
+CheckGrade(uint32_t step)
+{
+	result_t	regs	= { .name = "CalculateFrequencyRegisters()" };
+	result_t	small	= { .name = "Si549SmallChange()" };
+	uint32_t	freq;
+	uint32_t	n = 0;
+	uint16_t	hsdiv;
+	uint8_t		lsdiv;
+	real_t		dco, fout;
+
+	for (freq = R.MinimalOutputFreqeuency; freq <= R.MaximalOutputFreqeuency; freq += step, ++n)
+	{
+		regs.calls++;
+		CalculateFrequencyRegisters(freq);
+
+		fout = RefOutput(&dco, &hsdiv, &lsdiv);
+		if (hsdiv < 5 || hsdiv > 2046 || lsdiv > 5 || (lsdiv == 0 && hsdiv > 33 && (hsdiv & 1)))
+			regs.divErrors++;
+		AddDco(&regs, dco);
+		AddError(&regs, fout, freq);
+
+		// Small changes at the window edges of this center
+		if (n % CENTER_EVERY == 0 && R.SmoothTunePPM != 0)
+		{
+			uint32_t	bound = (uint32_t)((real_t)freq * R.SmoothTunePPM / 1000000);
+			uint32_t	f[4] = { freq - bound, freq + bound, freq - bound - 1, freq + bound + 1 };
+			uint8_t		i;
+
+			Si549SetCenter(freq);
+			for (i = 0; i < 4; ++i)
+			{
+				small.calls++;
+				if (Si549SmallChange(f[i]) != RefWindow(freq, f[i]))
+					small.windowErrors++;
+				if (!Si549SmallChange(f[i]))
+					continue;
+
+				AddDco(&small, dco * (1 + RefDeltaPPM() / 1000000));
+				AddError(&small, MHz(freq) * (1 + RefDeltaPPM() / 1000000), f[i]);
+			}
+		}
+	}
+
+	Report(&regs);
+	Report(&small);
+
+	return Errors(&regs) || Errors(&small);
+}
+
+#endif
+
+int
+main(int argc, char** argv)
+{
+	real_t		kHz = argc > 1 ? strtold(argv[1], NULL) : 10;
+	uint32_t	step = (uint32_t)(kHz * _2(21) / 1000);
+	uint8_t		grade;
+	int			errors = 0;
+
+	if (step == 0)
+	{
+		fprintf(stderr, "Step %s kHz is too small\n", argv[1]);
+		return 2;
+	}
+
+	printf("Xtal %.6Lf MHz, DCO %u - %u MHz, smooth tune %u PPM, step %.3Lf kHz\n",
+		XtalMHz(), R.SiChipDCOMin, R.SiChipDCOMax, R.SmoothTunePPM, kHz);
+
+	for (grade = CHIP_GRADE_A; grade < CHIP_GRADE_A + REF_GRADES; ++grade)
+	{
+		R.SiChipGrade = grade;
+		DeviceInit();
+		R.MaximalOutputFreqeuency = RefMaxFreq();	// Grade D of DeviceInit() is the grade A range
+		printf("Grade %c, %.3Lf - %.3Lf MHz\n", 'A' + grade - CHIP_GRADE_A,
+			MHz(R.MinimalOutputFreqeuency), MHz(R.MaximalOutputFreqeuency));
+		errors |= CheckGrade(step);
+	}
+
+	return errors;
+}
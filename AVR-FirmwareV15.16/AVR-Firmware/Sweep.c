@@ -0,0 +1,125 @@
+//************************************************************************
+//**
+//** Project......: Firmware USB AVR Si570 controler.
+//**
+//** Platform.....: ATtiny45
+//**
+//** Licence......: This software is freely available for non-commercial
+//**
+//** Programmer...: F.W. Krom, PE0FKO
+//**
+//** Description..: Frequency sweep, the frequency steps are done by the
+//**                main loop and not by a USB command for every step.
+//**                The SetFreq() will use the smooth tune write of the
+//**                chip for the steps within the PPM window.
+//**
+//** History......: Check the main.c file
+//**
+//**************************************************************************
+
+#include "main.h"
+
+#if INCLUDE_SWEEP
+
+static	uint32_t	SweepFreq;					// Running sweep frequency [11.21]
+static	uint32_t	SweepStep;					// Step size [11.21], two's complement
+static	uint16_t	SweepCount;					// Frequencies still to set, 0 is no sweep
+static	uint16_t	SweepDwell;					// Time of one frequency [ms]
+static	uint16_t	SweepTime;					// Tick of the last step
+static	uint8_t		SweepSync;					// IO_P2 is the sync output
+
+// IO_P2 is also IO_CW1, the dit input of the keyer, and the ABPF output.
+// On the ATtiny85 it is PB5, the RESET pin, never driven by the sweep.
+#if defined (__AVR_ATmega328P__)
+#define	SWEEP_SYNC		((R.ConfigFlags & CONFIG_SWEEP_SYNC) && !(R.ConfigFlags & CONFIG_ABPF) && R.KeyerMode == KEYER_OFF)
+#else
+#define	SWEEP_SYNC		false
+#endif
+
+// The sync output is a input again (no pull-up, as at startup),
+// the ABPF keeps its output.
+static void
+SweepSyncOff(void)
+{
+	if (SweepSync && !(R.ConfigFlags & CONFIG_ABPF))
+	{
+		bit_0(IO_DDR, IO_P2);
+		bit_0(IO_PORT, IO_P2);
+	}
+	SweepSync = false;
+}
+
+static void
+SweepSetFreq(void)
+{
+	SetFreq(SweepFreq, 0);
+	SweepCount--;
+
+	EventAdd(INTR_CMD_FREQ_CHANGE, SweepFreq);	// Freq changed interrupt for every step
+
+	if (!SWEEP_SYNC)							// Keyer or ABPF switched on while sweeping
+		SweepSyncOff();
+	else
+	if (SweepSync)
+		IO_PIN = _BV(IO_P2);					// Toggle the sync output
+
+	if (SweepCount == 0)
+		SweepStop();
+}
+
+// Start the sweep with the first frequency. Count zero will stop the sweep.
+void
+SweepStart(uint32_t start, uint32_t step, uint16_t count, uint16_t dwell)
+{
+	SweepFreq  = start;
+	SweepStep  = step;
+	SweepCount = count;
+	SweepDwell = dwell;
+
+	if (count != 0)
+	{
+		if (!SweepSync && SWEEP_SYNC)
+		{
+			SweepSync = true;
+			bit_1(IO_DDR, IO_P2);
+		}
+
+		SweepTime = TimerGetTicks();
+		SweepSetFreq();
+	}
+	else
+		SweepSyncOff();
+}
+
+void
+SweepStop(void)
+{
+	SweepCount = 0;
+	SweepSyncOff();
+}
+
+// Called from the main loop, set the next frequency after the dwell time.
+void
+SweepPoll(void)
+{
+	if (SweepCount == 0)
+		return;
+
+	if ((uint16_t)(TimerGetTicks() - SweepTime) < SweepDwell)
+		return;
+
+	SweepTime += SweepDwell;
+	SweepFreq += SweepStep;
+	SweepSetFreq();
+}
+
+// Reply: remaining count [16.0] and sweep frequency [11.21]
+uint8_t
+SweepStatus(uint8_t* reply)
+{
+	memcpy(&reply[0], &SweepCount, sizeof(SweepCount));
+	memcpy(&reply[2], &SweepFreq, sizeof(SweepFreq));
+	return sizeof(SweepCount) + sizeof(SweepFreq);
+}
+
+#endif
@@ -0,0 +1,124 @@
+//************************************************************************
+//**
+//** Project......: Firmware USB AVR Si570 controler.
+//**
+//** Platform.....: ATtiny45
+//**
+//** Licence......: This software is freely available for non-commercial
+//**                use - i.e. for research and experimentation only!
+//**
+//** Programmer...: F.W. Krom, PE0FKO
+//**
+//** Description..: Crystal temperature compensation with the CPU temperature.
+//**                Every second the temperature is read and filtered, the
+//**                xtal correction [8.24] is interpolated from the table
+//**                R.TempCompTemp / R.TempCompXtal. The correction is used
+//**                as a small frequency offset in SetFreq(), a change of the
+//**                correction will set the frequency again with the smooth
+//**                tune of the chip, and the hop table is calculated again.
+//**                The image cache needs no flush, it is keyed on the
+//**                corrected frequency.
+//**                Only with the config bit CONFIG_TEMP_COMP.
+//**
+//** History......: Check the main.c file
+//**
+//**************************************************************************
+
+#include "main.h"
+
+#if INCLUDE_TEMP_COMP
+
+#define	TEMP_COMP_PERIOD_MS		1000			// Time between the temperature readings
+#define	TEMP_COMP_IIR_SHIFT		4				// Filter y += (x - y) / 16
+
+static	uint16_t	TempCompTime;				// Tick of the last reading
+static	uint16_t	TempCompFilter;				// Filtered temperature [12.4]
+static	int16_t		TempCompCorr;				// Used xtal correction [8.24]
+static	int16_t		TempCompK;					// Correction / xtal [.30]
+
+// Interpolate the xtal correction between the table points,
+// the first point that is not higher ends the table.
+static int16_t
+TempCompXtal(uint16_t temp)
+{
+	uint8_t		i;
+	uint16_t	t0, t1;
+
+	t1 = R.TempCompTemp[0] << 4;
+	if (temp <= t1)
+		return R.TempCompXtal[0];
+
+	for (i = 1; i < TEMP_COMP_POINTS; ++i)
+	{
+		t0 = t1;
+		t1 = R.TempCompTemp[i] << 4;
+		if (t1 <= t0)
+			break;
+
+		if (temp < t1)
+			return R.TempCompXtal[i-1]
+				+ (int32_t)(R.TempCompXtal[i] - R.TempCompXtal[i-1]) * (temp - t0) / (t1 - t0);
+	}
+
+	return R.TempCompXtal[i-1];
+}
+
+// Called from the main loop, read the temperature every second.
+void
+TempCompPoll(void)
+{
+	uint16_t	temp;
+	int32_t		k = 0;
+
+	if ((uint16_t)(TimerGetTicks() - TempCompTime) < TEMP_COMP_PERIOD_MS)
+		return;
+
+	TempCompTime += TEMP_COMP_PERIOD_MS;
+
+	temp = GetTemperature() << 4;				// ADC [10.0] to [12.4]
+	if (TempCompFilter == 0)					// First reading
+		TempCompFilter = temp;
+	else
+		TempCompFilter += (int16_t)(temp - TempCompFilter + _BV(TEMP_COMP_IIR_SHIFT-1)) >> TEMP_COMP_IIR_SHIFT;
+
+	TempCompCorr = 0;
+	if (R.ConfigFlags & CONFIG_TEMP_COMP)
+	{
+		TempCompCorr = TempCompXtal(TempCompFilter);
+
+		// K = corr / xtal * 2^30 => [8.24] << 14 / [8.8]
+		k = ((int32_t)TempCompCorr << 14) / (uint16_t)(R.FreqXtal >> 16);
+		if (k > INT16_MAX) k = INT16_MAX;
+		if (k < INT16_MIN) k = INT16_MIN;
+	}
+
+	if (k != TempCompK)
+	{
+		TempCompK = k;
+		HopRecalc();							// Hop registers of the old correction
+		SetFreq(R.Freq, 0);						// Small change, smooth tune
+	}
+}
+
+// The xtal is xtal + corr, the output is freq * (1 + corr / xtal).
+// Return freq - freq * K, [11.5] * [.30] => [11.21]
+uint32_t
+TempCompFreq(uint32_t freq)
+{
+	return freq - (((int32_t)(freq >> 16) * TempCompK) >> 14);
+}
+
+// Reply: the table point of index, the filtered temperature [12.4]
+// and the used xtal correction [8.24].
+uint8_t
+TempCompStatus(uint8_t* reply, uint8_t index)
+{
+	index &= TEMP_COMP_POINTS-1;
+	memcpy(&reply[0], &R.TempCompTemp[index], sizeof(R.TempCompTemp[0]));
+	memcpy(&reply[2], &R.TempCompXtal[index], sizeof(R.TempCompXtal[0]));
+	memcpy(&reply[4], &TempCompFilter, sizeof(TempCompFilter));
+	memcpy(&reply[6], &TempCompCorr, sizeof(TempCompCorr));
+	return 8;
+}
+
+#endif
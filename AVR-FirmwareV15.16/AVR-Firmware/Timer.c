@@ -0,0 +1,99 @@
+//************************************************************************
+//**
+//** Project......: Firmware USB AVR Si570 controler.
+//**
+//** Platform.....: ATtiny45
+//**
+//** Licence......: This software is freely available for non-commercial
+//**
+//** Programmer...: F.W. Krom, PE0FKO
+//**
+//** Description..: Timer0 millisecond tick counter.
+//**                The interrupt is not blocking, the USB interrupt must
+//**                always be serviced within a few cycles.
+//**
+//** History......: Check the main.c file
+//**
+//**************************************************************************
+
+#include "main.h"
+#include <util/atomic.h>
+
+#if INCLUDE_TIMER
+
+// Timer0 CTC mode with clock / 256, about 1kHz:
+// 16.5MHz / 256 / 64 = 1007Hz, 16MHz / 256 / 63 = 992Hz.
+#define	TIMER_OCR		((F_CPU / 256 + 500) / 1000 - 1)
+
+static	volatile uint16_t	TimerTicks;
+
+ISR(TIMER0_COMPA_vect, ISR_NOBLOCK)
+{
+	TimerTicks++;
+
+#if INCLUDE_KEYER
+	KeyerTick();						// Keyer element and space timing
+#endif
+
+#if INCLUDE_HOP
+	HopTick();							// Dwell time of the frequency hop
+#endif
+}
+
+void
+TimerInit(void)
+{
+	TCCR0A = _BV(WGM01);				// CTC mode, TOP is OCR0A
+	OCR0A  = TIMER_OCR;
+	TCCR0B = _BV(CS02);					// Clock / 256
+
+#if defined (__AVR_ATtiny45__) || defined (__AVR_ATtiny85__)
+	TIMSK |= _BV(OCIE0A);
+#elif defined (__AVR_ATmega328P__)
+	TIMSK0 = _BV(OCIE0A);
+#else
+#error Define correct CPU.
+#endif
+}
+
+// Return the millisecond ticks, the 16 bits will wrap in 65s.
+uint16_t
+TimerGetTicks(void)
+{
+	uint16_t t;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		t = TimerTicks;
+	}
+	return t;
+}
+
+#if INCLUDE_PROFILE
+// Return the ticks and the timer counter, in timer counts of 256 CPU cycles.
+// A compare match not yet serviced by the interrupt is counted as a tick.
+uint16_t
+TimerGetCounts(void)
+{
+	uint16_t	t;
+	uint8_t		c;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		c = TCNT0;
+		t = TimerTicks;
+#if defined (__AVR_ATtiny45__) || defined (__AVR_ATtiny85__)
+		if (TIFR & _BV(OCF0A))
+#elif defined (__AVR_ATmega328P__)
+		if (TIFR0 & _BV(OCF0A))
+#endif
+		{
+			c = TCNT0;
+			t++;
+		}
+	}
+	return t * (TIMER_OCR + 1) + c;
+}
+#endif
+
+#endif
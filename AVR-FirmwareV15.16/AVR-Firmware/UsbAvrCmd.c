@@ -0,0 +1,528 @@
+//************************************************************************
+//**
+//** Project......: Firmware USB AVR Si570 controler.
+//**
+//** Platform.....: Host PC (gcc), not the AVR chip
+//**
+//** Licence......: This software is freely available for non-commercial
+//**                use - i.e. for research and experimentation only!
+//**
+//** Programmer...: F.W. Krom, PE0FKO
+//**
+//** Description..: Command line tool of the USB commands (UsbAvrHost.h),
+//**                to the AVR chip (libusb) or to the host build of the
+//**                firmware (-s, UsbAvrSim.c). Every verb is one command,
+//**                the reply is printed one value a line for the scripts.
+//**                The bench verb times the set frequency calls, single
+//**                CMD_SET_FREQ transfers and CMD_SET_LIST transfers with
+//**                the set frequency records that fit in the list (ATtiny
+//**                1, ATmega 3). With -s it is the host time of the command
+//**                code, with the chip it is the USB and firmware time.
+//**                Build:
+//**                  gcc -O2 -std=gnu99 -funsigned-char -fpack-struct -I. -DDEVICE_SI570 -o UsbAvrCmd UsbAvrCmd.c UsbAvrHost.c UsbAvrSim.c UsbAvrLibusb.c $(pkg-config --cflags --libs libusb-1.0) -lm
+//**                  -DDEVICE_SI549 for the Si549 firmware of -s, -D__AVR_ATmega328P__ for the ATmega.
+//**                  -DNO_LIBUSB without UsbAvrLibusb.c, only -s.
+//**                Use:
+//**                  UsbAvrCmd [-s] [-d serial] verb [args]
+//**                  UsbAvrCmd help		The verbs
+//**
+//** History......: Check the main.c file
+//**
+//**************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "UsbAvrHost.h"
+
+#define	BENCH_CALLS		10000				// Default set frequency calls of the bench
+#define	BENCH_START		14.0				// Tune from 14 MHz
+#define	BENCH_STEP		0.001				//   in 1 kHz steps
+#define	LIST_SIZE_TINY	16					// CMD_SET_LIST size of the ATtiny
+
+static	UsbAvr_t	Dev;
+static	int			Argc;
+static	char**		Argv;
+
+static const char	Help[] =
+	"UsbAvrCmd [-s] [-d serial] verb [args]\n"
+	"  -s                             host build of the firmware, no USB\n"
+	"  -d serial                      device with the serial number, PE0FKO-x\n"
+	"  version                        0x00 firmware version\n"
+	"  pin | port                     0x02 / 0x03 I/O pins\n"
+	"  setport value                  0x04 I/O port\n"
+	"  reboot                         0x0F watchdog reset\n"
+	"  crossover [index value]        0x17 filter cross over points [MHz], last index ABPF\n"
+	"  bandfilter [band filter]       0x18 / 0x19 filter of the bands\n"
+	"  chipreg reg value              0x20 write a chip register\n"
+	"  losm band [sub mul]            0x31 / 0x39 subtract [MHz] and multiply of the band\n"
+	"  freq [MHz]                     0x32 / 0x3A frequency\n"
+	"  xtal [MHz]                     0x33 / 0x3D crystal frequency\n"
+	"  startup [MHz]                  0x34 / 0x3C startup frequency\n"
+	"  ppm [ppm]                      0x35 / 0x3B smooth tune\n"
+	"  regs [index]                   0x3F chip registers\n"
+	"  i2c                            0x46 queued writes and errors\n"
+	"  i2caddr [addr]                 0x41 chip I2C address\n"
+	"  temp                           0x42 CPU temperature ADC\n"
+	"  usbid [id]                     0x43 serial number char\n"
+	"  grade grade index dco          0x44 chip grade, RFREQ index and DCO limit\n"
+	"  chip                           0x45 chip id, grade and factory xtal\n"
+	"  sweep [start step count dwell] 0x47 / 0x48 frequency sweep\n"
+	"  eeprom [commit]                0x49 / 0x4A eeprom write and state\n"
+	"  keyer [mode wpm weight]        0x4D / 0x4E CW keyer\n"
+	"  tempcomp index [adc xtal]      0x4F / 0x56 temperature compensation point\n"
+	"  ptt on | cwkey                 0x50 / 0x51 PTT and CW keys\n"
+	"  config [set clear]             0x55 config flags\n"
+	"  encoder index [step]           0x57 / 0x58 encoder step [MHz]\n"
+	"  profile [reset]                0x59 / 0x5A profile counters\n"
+	"  hop index MHz dwell            0x5B hop table entry\n"
+	"  hopstart count loops | hop     0x5C / 0x5D frequency hops\n"
+	"  cache [clear]                  0x5E image cache\n"
+	"  cycles MHz kHz                 0x5F CPU cycles of the frequency math\n"
+	"  raw in|out request value index [bytes]  any command, also 0x11, 0x1A, 0x3E, 0x60..0x6F\n"
+	"  bench [calls]                  set frequency calls per second, single and list\n";
+
+static double
+Now(void)
+{
+	struct timespec	t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static unsigned long
+ArgU(int i)
+{
+	return strtoul(Argv[i], NULL, 0);
+}
+
+static double
+ArgF(int i)
+{
+	return strtod(Argv[i], NULL);
+}
+
+static int
+Check(int n)
+{
+	if (n < 0)
+		fprintf(stderr, "%s\n", n == USBAVR_SHORT ? "Command not supported by the firmware" : "USB transfer error");
+	return n >= 0;
+}
+
+//---- Throughput
+
+// Single CMD_SET_FREQ transfers, calls per second.
+static int
+BenchSingle(long calls, double* rate)
+{
+	double		t = Now();
+	long		i;
+
+	for (i = 0; i < calls; ++i)
+		if (!Check(UsbAvrSetFreq(&Dev, BENCH_START + (i % 1000) * BENCH_STEP)))
+			return 0;
+
+	*rate = calls / (Now() - t);
+	return 1;
+}
+
+// CMD_SET_LIST transfers of the set frequency records that fit in size,
+// calls per second.
+static int
+BenchList(long calls, uint8_t size, uint8_t* perList, double* rate)
+{
+	UsbAvrList_t	list;
+	double			t;
+	long			i;
+
+	*perList = size / (USBAVR_LIST_HEADER + 4);
+
+	t = Now();
+	for (i = 0; i < calls; )
+	{
+		UsbAvrListInit(&list);
+		while (list.count < *perList && i < calls)
+		{
+			UsbAvrListAddFreq(&list, BENCH_START + (i % 1000) * BENCH_STEP);
+			++i;
+		}
+		if (UsbAvrSetList(&Dev, &list) < 0)
+			return 0;
+	}
+
+	*rate = calls / (Now() - t);
+	return 1;
+}
+
+static int
+Bench(long calls)
+{
+	double		single;
+	double		batch;
+	double		freq;
+	uint8_t		perList;
+	uint8_t		errors = 0;
+
+	if (!BenchSingle(calls, &single))
+		return 1;
+	printf("single   %ld calls  %10.0f calls/s  %8.2f us/call\n", calls, single, 1e6 / single);
+
+	// The ATtiny list is shorter, the firmware stalls a list that is too long
+	if (!BenchList(calls, USBAVR_LIST_SIZE, &perList, &batch)
+	&&	!BenchList(calls, LIST_SIZE_TINY, &perList, &batch))
+	{
+		fprintf(stderr, "USB transfer error\n");
+		return 1;
+	}
+	printf("list %u   %ld calls  %10.0f calls/s  %8.2f us/call\n", perList, calls, batch, 1e6 / batch);
+
+	// The last frequency must be the running one
+	if (!Check(UsbAvrGetFreq(&Dev, &freq)) || !Check(UsbAvrGetI2CStatus(&Dev, NULL, &errors)))
+		return 1;
+	if (UsbAvrTo11_21(freq) != UsbAvrTo11_21(BENCH_START + ((calls - 1) % 1000) * BENCH_STEP) || errors)
+	{
+		fprintf(stderr, "Frequency %.6f MHz, I2C errors %u\n", freq, errors);
+		return 1;
+	}
+	return 0;
+}
+
+//---- Verbs
+
+static int
+Raw(void)
+{
+	uint8_t		data[255];
+	uint16_t	len = 0;
+	uint8_t		dir;
+	int			i;
+	int			n;
+
+	if (Argc < 5)
+		return 2;
+
+	dir = strcmp(Argv[1], "in") == 0 ? USBAVR_IN : USBAVR_OUT;
+	if (dir == USBAVR_IN)
+		len = Argc > 5 && ArgU(5) < sizeof(data) ? ArgU(5) : sizeof(data);
+	else
+		for (i = 5; i < Argc && len < sizeof(data); ++i)
+			data[len++] = ArgU(i);
+
+	n = UsbAvrCommand(&Dev, dir, ArgU(2), ArgU(3), ArgU(4), data, len);
+	if (!Check(n))
+		return 1;
+
+	for (i = 0; dir == USBAVR_IN && i < n; ++i)
+		printf("0x%02X%c", data[i], i + 1 < n ? ' ' : '\n');
+	return 0;
+}
+
+// Return 0 done, 1 command error, 2 usage.
+static int
+Verb(void)
+{
+	const char*	v = Argv[0];
+	uint8_t		b[16];
+	uint16_t	w[16];
+	double		f, g;
+	int			i, n;
+
+	if (strcmp(v, "raw") == 0)
+		return Raw();
+
+	if (strcmp(v, "bench") == 0)
+		return Bench(Argc > 1 ? atol(Argv[1]) : BENCH_CALLS);
+
+	if (strcmp(v, "version") == 0)
+	{
+		if (!Check(UsbAvrGetVersion(&Dev, &w[0])))
+			return 1;
+		printf("%u.%u\n", w[0] >> 8, w[0] & 0xFF);
+	}
+	else
+	if (strcmp(v, "pin") == 0 || strcmp(v, "port") == 0)
+	{
+		if (!Check(v[1] == 'i' ? UsbAvrGetPin(&Dev, &b[0]) : UsbAvrGetPort(&Dev, &b[0])))
+			return 1;
+		printf("0x%02X\n", b[0]);
+	}
+	else
+	if (strcmp(v, "setport") == 0 && Argc > 1)
+	{
+		if (!Check(UsbAvrSetPort(&Dev, ArgU(1))))
+			return 1;
+	}
+	else
+	if (strcmp(v, "reboot") == 0)
+	{
+		UsbAvrReboot(&Dev);
+	}
+	else
+	if (strcmp(v, "crossover") == 0)
+	{
+		// A index out of the table only reads it
+		if (Argc > 2)
+			n = UsbAvrSetFilter(&Dev, ArgU(1), ArgU(1) == 3 ? ArgU(2) : UsbAvrTo11_5(ArgF(2)), w);
+		else
+			n = UsbAvrSetFilter(&Dev, 0xFF, 0, w);
+		if (!Check(n))
+			return 1;
+		for (i = 0; i < 3; ++i)
+			printf("%.5f\n", UsbAvrFrom11_5(w[i]));
+		printf("%u\n", w[3]);
+	}
+	else
+	if (strcmp(v, "bandfilter") == 0)
+	{
+		if (!Check(Argc > 2 ? UsbAvrSetRxBandFilter(&Dev, ArgU(1), ArgU(2), b) : UsbAvrGetRxBandFilter(&Dev, b)))
+			return 1;
+		for (i = 0; i < 4; ++i)
+			printf("%u\n", b[i]);
+	}
+	else
+	if (strcmp(v, "chipreg") == 0 && Argc > 2)
+	{
+		if (!Check(UsbAvrSetChipReg(&Dev, ArgU(1), ArgU(2), &b[0])))
+			return 1;
+		printf("%u\n", b[0]);
+	}
+	else
+	if (strcmp(v, "losm") == 0 && Argc > 1)
+	{
+		if (Argc > 3 && !Check(UsbAvrSetLoSm(&Dev, ArgU(1), ArgF(2), ArgF(3))))
+			return 1;
+		if (!Check(UsbAvrGetLoSm(&Dev, ArgU(1), &f, &g)))
+			return 1;
+		printf("%.6f\n%.6f\n", f, g);
+	}
+	else
+	if (strcmp(v, "freq") == 0 || strcmp(v, "xtal") == 0 || strcmp(v, "startup") == 0)
+	{
+		if (v[0] == 'f')
+			n = Argc > 1 ? UsbAvrSetFreq(&Dev, ArgF(1)) : UsbAvrGetFreq(&Dev, &f);
+		else
+		if (v[0] == 'x')
+			n = Argc > 1 ? UsbAvrSetXtal(&Dev, ArgF(1)) : UsbAvrGetXtal(&Dev, &f);
+		else
+			n = Argc > 1 ? UsbAvrSetStartup(&Dev, ArgF(1)) : UsbAvrGetStartup(&Dev, &f);
+		if (!Check(n))
+			return 1;
+		if (Argc == 1)
+			printf("%.6f\n", f);
+	}
+	else
+	if (strcmp(v, "ppm") == 0)
+	{
+		if (!Check(Argc > 1 ? UsbAvrSetPpm(&Dev, ArgU(1)) : UsbAvrGetPpm(&Dev, &w[0])))
+			return 1;
+		if (Argc == 1)
+			printf("%u\n", w[0]);
+	}
+	else
+	if (strcmp(v, "regs") == 0)
+	{
+		n = UsbAvrGetChipRegs(&Dev, Argc > 1 ? ArgU(1) : 0, b);
+		if (!Check(n))
+			return 1;
+		for (i = 0; i < n; ++i)
+			printf("0x%02X%c", b[i], i + 1 < n ? ' ' : '\n');
+	}
+	else
+	if (strcmp(v, "i2c") == 0)
+	{
+		if (!Check(UsbAvrGetI2CStatus(&Dev, &b[0], &b[1])))
+			return 1;
+		printf("%u\n%u\n", b[0], b[1]);
+	}
+	else
+	if (strcmp(v, "i2caddr") == 0 || strcmp(v, "usbid") == 0)
+	{
+		n = v[0] == 'i'
+			? UsbAvrSetI2CAddr(&Dev, Argc > 1 ? ArgU(1) : 0, &b[0])
+			: UsbAvrSetUsbId(&Dev, Argc > 1 ? (uint8_t)Argv[1][0] : 0, &b[0]);
+		if (!Check(n))
+			return 1;
+		printf(v[0] == 'i' ? "0x%02X\n" : "%c\n", b[0]);
+	}
+	else
+	if (strcmp(v, "temp") == 0)
+	{
+		if (!Check(UsbAvrGetCpuTemp(&Dev, &w[0])))
+			return 1;
+		printf("%u\n", w[0]);
+	}
+	else
+	if (strcmp(v, "grade") == 0 && Argc > 3)
+	{
+		if (!Check(UsbAvrSetGrade(&Dev, ArgU(1), ArgU(2), ArgU(3), b)))
+			return 1;
+		printf("%u\n%u\n%u\n%u\n", b[0] | (b[1] << 8), b[2] | (b[3] << 8), b[4], b[5]);
+	}
+	else
+	if (strcmp(v, "chip") == 0)
+	{
+		if (!Check(UsbAvrGetChipInfo(&Dev, &b[0], &b[1], &f)))
+			return 1;
+		printf("0x%02X\n%u\n%.6f\n", b[0], b[1], f);
+	}
+	else
+	if (strcmp(v, "sweep") == 0)
+	{
+		if (Argc > 4)
+			n = UsbAvrSetSweep(&Dev, ArgF(1), ArgF(2), ArgU(3), ArgU(4));
+		else
+			n = UsbAvrGetSweep(&Dev, &w[0], &f);
+		if (!Check(n))
+			return 1;
+		if (Argc <= 4)
+			printf("%u\n%.6f\n", w[0], f);
+	}
+	else
+	if (strcmp(v, "eeprom") == 0)
+	{
+		if (!Check(UsbAvrEepromCommit(&Dev, Argc > 1, &b[0]))
+		||	!Check(UsbAvrGetEepromCrc(&Dev, &b[1], &w[0], &b[2])))
+			return 1;
+		printf("%u\n%u\n0x%04X\n%u\n", b[0], b[1], w[0], b[2]);
+	}
+	else
+	if (strcmp(v, "keyer") == 0)
+	{
+		if (Argc > 3 && !Check(UsbAvrSetKeyer(&Dev, ArgU(1), ArgU(2), ArgU(3))))
+			return 1;
+		if (!Check(UsbAvrGetKeyer(&Dev, &b[0], &b[1], &b[2])))
+			return 1;
+		printf("%u\n%u\n%u\n", b[0], b[1], b[2]);
+	}
+	else
+	if (strcmp(v, "tempcomp") == 0 && Argc > 1)
+	{
+		int16_t		xtal, corr;
+
+		if (Argc > 3 && !Check(UsbAvrSetTempComp(&Dev, ArgU(1), ArgU(2), strtol(Argv[3], NULL, 0))))
+			return 1;
+		if (!Check(UsbAvrGetTempComp(&Dev, ArgU(1), &w[0], &xtal, &w[1], &corr)))
+			return 1;
+		printf("%u\n%d\n%u\n%d\n", w[0], xtal, w[1], corr);
+	}
+	else
+	if (strcmp(v, "ptt") == 0 || strcmp(v, "cwkey") == 0)
+	{
+		n = v[0] == 'p' ? UsbAvrSetPtt(&Dev, Argc > 1 ? ArgU(1) : 0, &b[0]) : UsbAvrGetCwKey(&Dev, &b[0]);
+		if (!Check(n))
+			return 1;
+		printf("0x%02X\n", b[0]);
+	}
+	else
+	if (strcmp(v, "config") == 0)
+	{
+		if (!Check(UsbAvrConfig(&Dev, Argc > 1 ? ArgU(1) : 0, Argc > 2 ? ArgU(2) : 0, &b[0])))
+			return 1;
+		printf("0x%02X\n", b[0]);
+	}
+	else
+	if (strcmp(v, "encoder") == 0 && Argc > 1)
+	{
+		if (Argc > 2 && !Check(UsbAvrSetEncoder(&Dev, ArgU(1), ArgF(2))))
+			return 1;
+		if (!Check(UsbAvrGetEncoder(&Dev, ArgU(1), &f)))
+			return 1;
+		printf("%.6f\n", f);
+	}
+	else
+	if (strcmp(v, "profile") == 0)
+	{
+		if (Argc > 1)
+			return Check(UsbAvrResetProfile(&Dev)) ? 0 : 1;
+		if (!Check(UsbAvrGetProfile(&Dev, w)))
+			return 1;
+		for (i = 0; i < 15; i += 3)
+			printf("%u %u %u\n", w[i], w[i + 1], w[i + 2]);
+	}
+	else
+	if (strcmp(v, "hop") == 0)
+	{
+		if (Argc > 3)
+			return Check(UsbAvrSetHop(&Dev, ArgU(1), ArgF(2), ArgU(3))) ? 0 : 1;
+		if (!Check(UsbAvrGetHop(&Dev, &b[0], &b[1], &w[0])))
+			return 1;
+		printf("%u\n%u\n%u\n", b[0], b[1], w[0]);
+	}
+	else
+	if (strcmp(v, "hopstart") == 0 && Argc > 2)
+	{
+		if (!Check(UsbAvrStartHop(&Dev, ArgU(1), ArgU(2))))
+			return 1;
+	}
+	else
+	if (strcmp(v, "cache") == 0)
+	{
+		if (!Check(UsbAvrGetImageCache(&Dev, Argc > 1, &w[0], &w[1], &b[0])))
+			return 1;
+		printf("%u\n%u\n%u\n", w[0], w[1], b[0]);
+	}
+	else
+	if (strcmp(v, "cycles") == 0 && Argc > 2)
+	{
+		if (!Check(UsbAvrGetBench(&Dev, ArgU(1), ArgU(2), w)))
+			return 1;
+		printf("%u\n%u\n%u\n%u\n", w[0], w[1], w[2], w[3]);
+	}
+	else
+		return 2;
+
+	return 0;
+}
+
+int
+main(int argc, char** argv)
+{
+	const char*	serial = NULL;
+	int			sim = 0;
+	int			opt;
+	int			rc;
+
+	while ((opt = getopt(argc, argv, "sd:")) != -1)
+	{
+		if (opt == 's')
+			sim = 1;
+		else
+		if (opt == 'd')
+			serial = optarg;
+		else
+		{
+			fputs(Help, stderr);
+			return 2;
+		}
+	}
+
+	Argc = argc - optind;
+	Argv = argv + optind;
+	if (Argc == 0 || strcmp(Argv[0], "help") == 0)
+	{
+		fputs(Help, Argc == 0 ? stderr : stdout);
+		return Argc == 0 ? 2 : 0;
+	}
+
+#if defined(NO_LIBUSB)
+	rc = sim ? UsbAvrOpenSim(&Dev) : USBAVR_ERROR;	// Only the host build of the firmware
+#else
+	rc = sim ? UsbAvrOpenSim(&Dev) : UsbAvrOpenLibusb(&Dev, serial);
+#endif
+	if (rc < 0)
+	{
+		fprintf(stderr, "Device %s not found\n", serial != NULL ? serial : USBAVR_PRODUCT);
+		return 1;
+	}
+
+	rc = Verb();
+	if (rc == 2)
+		fputs(Help, stderr);
+
+	UsbAvrClose(&Dev);
+	return rc;
+}
@@ -0,0 +1,735 @@
+//************************************************************************
+//**
+//** Project......: Firmware USB AVR Si570 controler.
+//**
+//** Platform.....: Host PC (gcc), not the AVR chip
+//**
+//** Licence......: This software is freely available for non-commercial
+//**                use - i.e. for research and experimentation only!
+//**
+//** Programmer...: F.W. Krom, PE0FKO
+//**
+//** Description..: Host library of the USB commands, see UsbAvrHost.h.
+//**                The set commands without data and the get commands are
+//**                IN transfers with the reply size as wLength, the commands
+//**                with data (0x30..0x35, 0x47, 0x4B, 0x4F, 0x57, 0x5B) are
+//**                OUT transfers. The AVR is little endian, the values are
+//**                packed byte by byte.
+//**
+//** History......: Check the main.c file
+//**
+//**************************************************************************
+
+#include <string.h>
+#include <math.h>
+#include "UsbAvrHost.h"
+
+#define	MAX_RX_BAND		4						// Bands of the filter tables
+
+static uint16_t
+Get16(const uint8_t* p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static uint32_t
+Get32(const uint8_t* p)
+{
+	return Get16(p) | ((uint32_t)Get16(p + 2) << 16);
+}
+
+static void
+Put16(uint8_t* p, uint16_t value)
+{
+	p[0] = value;
+	p[1] = value >> 8;
+}
+
+static void
+Put32(uint8_t* p, uint32_t value)
+{
+	Put16(p, value);
+	Put16(p + 2, value >> 16);
+}
+
+//---- Fixed point conversion
+
+uint32_t
+UsbAvrTo11_21(double mhz)
+{
+	return (uint32_t)llround(mhz * (1 << 21));
+}
+
+double
+UsbAvrFrom11_21(uint32_t value)
+{
+	return value / (double)(1 << 21);
+}
+
+uint32_t
+UsbAvrTo8_24(double mhz)
+{
+	return (uint32_t)llround(mhz * (1 << 24));
+}
+
+double
+UsbAvrFrom8_24(uint32_t value)
+{
+	return value / (double)(1 << 24);
+}
+
+uint16_t
+UsbAvrTo11_5(double mhz)
+{
+	return (uint16_t)lround(mhz * (1 << 5));
+}
+
+double
+UsbAvrFrom11_5(uint16_t value)
+{
+	return value / (double)(1 << 5);
+}
+
+//---- Transfers
+
+void
+UsbAvrClose(UsbAvr_t* dev)
+{
+	if (dev->close != NULL)
+		dev->close(dev->handle);
+	dev->handle = NULL;
+	dev->control = NULL;
+	dev->close = NULL;
+}
+
+int
+UsbAvrCommand(UsbAvr_t* dev, uint8_t dir, uint8_t request,
+	uint16_t value, uint16_t index, uint8_t* data, uint16_t len)
+{
+	if (dev->control == NULL)
+		return USBAVR_ERROR;
+
+	return dev->control(dev->handle, dir, request, value, index, data, len);
+}
+
+// IN transfer of a command with a reply of len bytes, USBAVR_SHORT when
+// the device returns less (0xFF, the command is not in the firmware).
+static int
+In(UsbAvr_t* dev, uint8_t request, uint16_t value, uint16_t index, uint8_t* data, uint16_t len)
+{
+	int		n = UsbAvrCommand(dev, USBAVR_IN, request, value, index, data, len);
+
+	return n < 0 || n >= len ? n : USBAVR_SHORT;
+}
+
+static int
+Out(UsbAvr_t* dev, uint8_t request, uint16_t value, uint16_t index, uint8_t* data, uint16_t len)
+{
+	return UsbAvrCommand(dev, USBAVR_OUT, request, value, index, data, len);
+}
+
+static int
+In8(UsbAvr_t* dev, uint8_t request, uint16_t value, uint16_t index, uint8_t* result)
+{
+	uint8_t		reply[1];
+	int			n = In(dev, request, value, index, reply, sizeof(reply));
+
+	if (n > 0 && result != NULL)
+		*result = reply[0];
+	return n;
+}
+
+static int
+In16(UsbAvr_t* dev, uint8_t request, uint16_t value, uint16_t index, uint16_t* result)
+{
+	uint8_t		reply[2];
+	int			n = In(dev, request, value, index, reply, sizeof(reply));
+
+	if (n > 0 && result != NULL)
+		*result = Get16(reply);
+	return n;
+}
+
+static int
+In32(UsbAvr_t* dev, uint8_t request, uint16_t value, uint16_t index, uint32_t* result)
+{
+	uint8_t		reply[4];
+	int			n = In(dev, request, value, index, reply, sizeof(reply));
+
+	if (n > 0 && result != NULL)
+		*result = Get32(reply);
+	return n;
+}
+
+static int
+Out32(UsbAvr_t* dev, uint8_t request, uint16_t index, uint32_t value)
+{
+	uint8_t		data[4];
+
+	Put32(data, value);
+	return Out(dev, request, 0, index, data, sizeof(data));
+}
+
+//---- Commands
+
+int
+UsbAvrGetVersion(UsbAvr_t* dev, uint16_t* version)
+{
+	return In16(dev, CMD_GET_VERSION, 0, 0, version);
+}
+
+int
+UsbAvrSetDdr(UsbAvr_t* dev, uint8_t ddr)
+{
+	return In(dev, CMD_SET_DDR, ddr, 0, NULL, 0);
+}
+
+int
+UsbAvrGetPin(UsbAvr_t* dev, uint8_t* pin)
+{
+	return In8(dev, CMD_GET_PIN, 0, 0, pin);
+}
+
+int
+UsbAvrGetPort(UsbAvr_t* dev, uint8_t* port)
+{
+	return In8(dev, CMD_GET_PORT, 0, 0, port);
+}
+
+int
+UsbAvrSetPort(UsbAvr_t* dev, uint8_t port)
+{
+	return In(dev, CMD_SET_PORT, port, 0, NULL, 0);
+}
+
+// The firmware waits for the watchdog reset, no reply and the device is gone.
+int
+UsbAvrReboot(UsbAvr_t* dev)
+{
+	UsbAvrCommand(dev, USBAVR_IN, CMD_REBOOT, 0, 0, NULL, 0);
+	return 0;
+}
+
+int
+UsbAvrSetIo(UsbAvr_t* dev, uint8_t mask, uint8_t data, uint16_t* io)
+{
+	return In16(dev, CMD_SET_IO, mask, data, io);
+}
+
+int
+UsbAvrGetIo(UsbAvr_t* dev, uint16_t* io)
+{
+	return In16(dev, CMD_GET_IO, 0, 0, io);
+}
+
+// Cross over point index [11.5], the last index is the ABPF on / off.
+// The reply is the table of all points.
+int
+UsbAvrSetFilter(UsbAvr_t* dev, uint8_t index, uint16_t value, uint16_t crossOver[4])
+{
+	uint8_t		reply[2 * MAX_RX_BAND];
+	int			n = In(dev, CMD_SET_FILTER, value, index, reply, sizeof(reply));
+	uint8_t		i;
+
+	if (n > 0 && crossOver != NULL)
+		for (i = 0; i < MAX_RX_BAND; ++i)
+			crossOver[i] = Get16(&reply[2 * i]);
+	return n;
+}
+
+int
+UsbAvrSetRxBandFilter(UsbAvr_t* dev, uint8_t band, uint8_t filter, uint8_t filters[4])
+{
+	uint8_t		reply[MAX_RX_BAND];
+	int			n = In(dev, CMD_SET_RX_BAND_FILTER, filter, band, reply, sizeof(reply));
+
+	if (n > 0 && filters != NULL)
+		memcpy(filters, reply, sizeof(reply));
+	return n;
+}
+
+int
+UsbAvrGetRxBandFilter(UsbAvr_t* dev, uint8_t filters[4])
+{
+	uint8_t		reply[MAX_RX_BAND];
+	int			n = In(dev, CMD_GET_RX_BAND_FILTER, 0, 0, reply, sizeof(reply));
+
+	if (n > 0 && filters != NULL)
+		memcpy(filters, reply, sizeof(reply));
+	return n;
+}
+
+// Register in the high byte of wValue, as the DG8SAQ firmware.
+int
+UsbAvrSetChipReg(UsbAvr_t* dev, uint8_t reg, uint8_t data, uint8_t* i2cErrors)
+{
+	return In8(dev, CMD_SET_SI570, reg << 8, data, i2cErrors);
+}
+
+int
+UsbAvrSetFreqReg(UsbAvr_t* dev, const uint8_t reg[6])
+{
+	uint8_t		data[6];
+
+	memcpy(data, reg, sizeof(data));
+	return Out(dev, CMD_SET_FREQ_REG, 0, 0, data, sizeof(data));
+}
+
+// Subtract [11.21] (signed) and multiply [11.21] of the band.
+int
+UsbAvrSetLoSm(UsbAvr_t* dev, uint8_t band, double sub, double mul)
+{
+	uint8_t		data[8];
+
+	Put32(&data[0], (uint32_t)(int32_t)llround(sub * (1 << 21)));
+	Put32(&data[4], UsbAvrTo11_21(mul));
+	return Out(dev, CMD_SET_LO_SM, 0, band, data, sizeof(data));
+}
+
+int
+UsbAvrSetFreq(UsbAvr_t* dev, double mhz)
+{
+	return Out32(dev, CMD_SET_FREQ, 0, UsbAvrTo11_21(mhz));
+}
+
+int
+UsbAvrSetXtal(UsbAvr_t* dev, double mhz)
+{
+	return Out32(dev, CMD_SET_XTAL, 0, UsbAvrTo8_24(mhz));
+}
+
+int
+UsbAvrSetStartup(UsbAvr_t* dev, double mhz)
+{
+	return Out32(dev, CMD_SET_STARTUP, 0, UsbAvrTo11_21(mhz));
+}
+
+int
+UsbAvrSetPpm(UsbAvr_t* dev, uint16_t ppm)
+{
+	uint8_t		data[2];
+
+	Put16(data, ppm);
+	return Out(dev, CMD_SET_PPM, 0, 0, data, sizeof(data));
+}
+
+int
+UsbAvrGetLoSm(UsbAvr_t* dev, uint8_t band, double* sub, double* mul)
+{
+	uint8_t		reply[8];
+	int			n = In(dev, CMD_GET_LO_SM, 0, band, reply, sizeof(reply));
+
+	if (n > 0)
+	{
+		if (sub != NULL)
+			*sub = (int32_t)Get32(&reply[0]) / (double)(1 << 21);
+		if (mul != NULL)
+			*mul = UsbAvrFrom11_21(Get32(&reply[4]));
+	}
+	return n;
+}
+
+int
+UsbAvrGetFreq(UsbAvr_t* dev, double* mhz)
+{
+	uint32_t	value;
+	int			n = In32(dev, CMD_GET_FREQ, 0, 0, &value);
+
+	if (n > 0 && mhz != NULL)
+		*mhz = UsbAvrFrom11_21(value);
+	return n;
+}
+
+int
+UsbAvrGetPpm(UsbAvr_t* dev, uint16_t* ppm)
+{
+	return In16(dev, CMD_GET_PPM, 0, 0, ppm);
+}
+
+int
+UsbAvrGetStartup(UsbAvr_t* dev, double* mhz)
+{
+	uint32_t	value;
+	int			n = In32(dev, CMD_GET_STARTUP, 0, 0, &value);
+
+	if (n > 0 && mhz != NULL)
+		*mhz = UsbAvrFrom11_21(value);
+	return n;
+}
+
+int
+UsbAvrGetXtal(UsbAvr_t* dev, double* mhz)
+{
+	uint32_t	value;
+	int			n = In32(dev, CMD_GET_XTAL, 0, 0, &value);
+
+	if (n > 0 && mhz != NULL)
+		*mhz = UsbAvrFrom8_24(value);
+	return n;
+}
+
+// Si570 registers 7..12 or 13..18 (index 0 is the used one), 6 bytes.
+// Si549 registers 23..31 and 231..233, 11 bytes. The reply size is the chip.
+int
+UsbAvrGetChipRegs(UsbAvr_t* dev, uint8_t index, uint8_t reg[11])
+{
+	return UsbAvrCommand(dev, USBAVR_IN, CMD_GET_SI570, 0, index, reg, 11);
+}
+
+int
+UsbAvrGetI2CErrors(UsbAvr_t* dev, uint8_t* i2cErrors)
+{
+	return In8(dev, CMD_GET_I2C_ERR, 0, 0, i2cErrors);
+}
+
+// Address 0 only reads the address.
+int
+UsbAvrSetI2CAddr(UsbAvr_t* dev, uint8_t addr, uint8_t* old)
+{
+	return In8(dev, CMD_SET_I2C_ADDR, addr, 0, old);
+}
+
+int
+UsbAvrGetCpuTemp(UsbAvr_t* dev, uint16_t* adc)
+{
+	return In16(dev, CMD_GET_CPU_TEMP, 0, 0, adc);
+}
+
+// Id 0 only reads the last char of the serial number "PE0FKO-x".
+int
+UsbAvrSetUsbId(UsbAvr_t* dev, uint8_t id, uint8_t* old)
+{
+	return In8(dev, CMD_GET_USB_ID, id, 0, old);
+}
+
+// Grade 0 does not change the grade, dco 0 not the DCO limit: the minimum
+// with rfreqIndex 0, else the maximum. Reply: DCO min, max, grade, index.
+int
+UsbAvrSetGrade(UsbAvr_t* dev, uint8_t grade, uint8_t rfreqIndex, uint16_t dco, uint8_t reply[6])
+{
+	return In(dev, CMD_SET_SI570_GRADE, grade | (rfreqIndex << 8), dco, reply, 6);
+}
+
+int
+UsbAvrGetChipInfo(UsbAvr_t* dev, uint8_t* chip, uint8_t* grade, double* xtal)
+{
+	uint8_t		reply[6];
+	int			n = In(dev, CMD_GET_CHIP_INFO, 0, 0, reply, sizeof(reply));
+
+	if (n > 0)
+	{
+		if (chip != NULL)
+			*chip = reply[0];
+		if (grade != NULL)
+			*grade = reply[1];
+		if (xtal != NULL)
+			*xtal = UsbAvrFrom8_24(Get32(&reply[2]));
+	}
+	return n;
+}
+
+int
+UsbAvrGetI2CStatus(UsbAvr_t* dev, uint8_t* queued, uint8_t* i2cErrors)
+{
+	uint8_t		reply[2];
+	int			n = In(dev, CMD_GET_I2C_STATUS, 0, 0, reply, sizeof(reply));
+
+	if (n > 0)
+	{
+		if (queued != NULL)
+			*queued = reply[0];
+		if (i2cErrors != NULL)
+			*i2cErrors = reply[1];
+	}
+	return n;
+}
+
+// Count 0 stops the sweep, dwell [ms] a step.
+int
+UsbAvrSetSweep(UsbAvr_t* dev, double start, double step, uint16_t count, uint16_t dwell)
+{
+	uint8_t		data[8];
+
+	Put32(&data[0], UsbAvrTo11_21(start));
+	Put32(&data[4], UsbAvrTo11_21(step));
+	return Out(dev, CMD_SET_SWEEP, count, dwell, data, sizeof(data));
+}
+
+int
+UsbAvrGetSweep(UsbAvr_t* dev, uint16_t* count, double* mhz)
+{
+	uint8_t		reply[6];
+	int			n = In(dev, CMD_GET_SWEEP, 0, 0, reply, sizeof(reply));
+
+	if (n > 0)
+	{
+		if (count != NULL)
+			*count = Get16(&reply[0]);
+		if (mhz != NULL)
+			*mhz = UsbAvrFrom11_21(Get32(&reply[2]));
+	}
+	return n;
+}
+
+int
+UsbAvrEepromCommit(UsbAvr_t* dev, uint8_t commit, uint8_t* dirty)
+{
+	return In8(dev, CMD_EEPROM_COMMIT, commit, 0, dirty);
+}
+
+int
+UsbAvrGetEepromCrc(UsbAvr_t* dev, uint8_t* version, uint16_t* crc, uint8_t* state)
+{
+	uint8_t		reply[4];
+	int			n = In(dev, CMD_GET_EEPROM_CRC, 0, 0, reply, sizeof(reply));
+
+	if (n > 0)
+	{
+		if (version != NULL)
+			*version = reply[0];
+		if (crc != NULL)
+			*crc = Get16(&reply[1]);
+		if (state != NULL)
+			*state = reply[3];
+	}
+	return n;
+}
+
+int
+UsbAvrSetList(UsbAvr_t* dev, const UsbAvrList_t* list)
+{
+	uint8_t		data[USBAVR_LIST_SIZE];
+
+	memcpy(data, list->data, list->len);
+	return Out(dev, CMD_SET_LIST, 0, 0, data, list->len);
+}
+
+// Reply: the length and the reply of every command of the list.
+int
+UsbAvrGetList(UsbAvr_t* dev, uint8_t* reply, uint16_t len)
+{
+	return UsbAvrCommand(dev, USBAVR_IN, CMD_GET_LIST, 0, 0, reply, len);
+}
+
+int
+UsbAvrSetKeyer(UsbAvr_t* dev, uint8_t mode, uint8_t wpm, uint8_t weight)
+{
+	uint8_t		reply[3];
+
+	return In(dev, CMD_SET_KEYER, mode | (wpm << 8), weight, reply, sizeof(reply));
+}
+
+int
+UsbAvrGetKeyer(UsbAvr_t* dev, uint8_t* mode, uint8_t* wpm, uint8_t* weight)
+{
+	uint8_t		reply[3];
+	int			n = In(dev, CMD_GET_KEYER, 0, 0, reply, sizeof(reply));
+
+	if (n > 0)
+	{
+		if (mode != NULL)
+			*mode = reply[0];
+		if (wpm != NULL)
+			*wpm = reply[1];
+		if (weight != NULL)
+			*weight = reply[2];
+	}
+	return n;
+}
+
+// Point index: temperature ADC value (CMD_GET_CPU_TEMP) and xtal correction [8.24].
+int
+UsbAvrSetTempComp(UsbAvr_t* dev, uint8_t index, uint16_t adc, int16_t xtal)
+{
+	uint8_t		data[4];
+
+	Put16(&data[0], adc);
+	Put16(&data[2], xtal);
+	return Out(dev, CMD_SET_TEMP_COMP, 0, index, data, sizeof(data));
+}
+
+// Reply: CW key 1 and 2 bits of the I/O port.
+int
+UsbAvrSetPtt(UsbAvr_t* dev, uint8_t on, uint8_t* keys)
+{
+	return In8(dev, CMD_SET_PTT, on, 0, keys);
+}
+
+int
+UsbAvrGetCwKey(UsbAvr_t* dev, uint8_t* keys)
+{
+	return In8(dev, CMD_GET_CW_KEY, 0, 0, keys);
+}
+
+// Set and clear the CONFIG_xxx bits, reply the new flags.
+int
+UsbAvrConfig(UsbAvr_t* dev, uint8_t set, uint8_t clear, uint8_t* flags)
+{
+	return In8(dev, CMD_CONFIG, set, clear, flags);
+}
+
+int
+UsbAvrGetTempComp(UsbAvr_t* dev, uint8_t index, uint16_t* adc, int16_t* xtal, uint16_t* filter, int16_t* corr)
+{
+	uint8_t		reply[8];
+	int			n = In(dev, CMD_GET_TEMP_COMP, 0, index, reply, sizeof(reply));
+
+	if (n > 0)
+	{
+		if (adc != NULL)
+			*adc = Get16(&reply[0]);
+		if (xtal != NULL)
+			*xtal = (int16_t)Get16(&reply[2]);
+		if (filter != NULL)
+			*filter = Get16(&reply[4]);
+		if (corr != NULL)
+			*corr = (int16_t)Get16(&reply[6]);
+	}
+	return n;
+}
+
+int
+UsbAvrSetEncoder(UsbAvr_t* dev, uint8_t index, double step)
+{
+	return Out32(dev, CMD_SET_ENCODER, index, UsbAvrTo11_21(step));
+}
+
+int
+UsbAvrGetEncoder(UsbAvr_t* dev, uint8_t index, double* step)
+{
+	uint32_t	value;
+	int			n = In32(dev, CMD_GET_ENCODER, 0, index, &value);
+
+	if (n > 0 && step != NULL)
+		*step = UsbAvrFrom11_21(value);
+	return n;
+}
+
+int
+UsbAvrGetProfile(UsbAvr_t* dev, uint16_t counters[15])
+{
+	uint8_t		reply[30];
+	int			n = In(dev, CMD_GET_PROFILE, 0, 0, reply, sizeof(reply));
+	uint8_t		i;
+
+	if (n > 0 && counters != NULL)
+		for (i = 0; i < 15; ++i)
+			counters[i] = Get16(&reply[2 * i]);
+	return n;
+}
+
+int
+UsbAvrResetProfile(UsbAvr_t* dev)
+{
+	return In(dev, CMD_RESET_PROFILE, 0, 0, NULL, 0);
+}
+
+int
+UsbAvrSetHop(UsbAvr_t* dev, uint8_t index, double mhz, uint16_t dwell)
+{
+	uint8_t		data[6];
+
+	Put32(&data[0], UsbAvrTo11_21(mhz));
+	Put16(&data[4], dwell);
+	return Out(dev, CMD_SET_HOP, 0, index, data, sizeof(data));
+}
+
+// Count 0 stops the hops, loops 0 is endless.
+int
+UsbAvrStartHop(UsbAvr_t* dev, uint8_t count, uint8_t loops)
+{
+	uint8_t		reply[4];
+
+	return In(dev, CMD_START_HOP, count, loops, reply, sizeof(reply));
+}
+
+int
+UsbAvrGetHop(UsbAvr_t* dev, uint8_t* entry, uint8_t* loops, uint16_t* ms)
+{
+	uint8_t		reply[4];
+	int			n = In(dev, CMD_GET_HOP, 0, 0, reply, sizeof(reply));
+
+	if (n > 0)
+	{
+		if (entry != NULL)
+			*entry = reply[0];
+		if (loops != NULL)
+			*loops = reply[1];
+		if (ms != NULL)
+			*ms = Get16(&reply[2]);
+	}
+	return n;
+}
+
+int
+UsbAvrGetImageCache(UsbAvr_t* dev, uint8_t clear, uint16_t* hits, uint16_t* misses, uint8_t* used)
+{
+	uint8_t		reply[5];
+	int			n = In(dev, CMD_GET_IMAGE_CACHE, clear, 0, reply, sizeof(reply));
+
+	if (n > 0)
+	{
+		if (hits != NULL)
+			*hits = Get16(&reply[0]);
+		if (misses != NULL)
+			*misses = Get16(&reply[2]);
+		if (used != NULL)
+			*used = reply[4];
+	}
+	return n;
+}
+
+// CPU cycles of the frequency math at mhz with khz steps, Si570: divider,
+// RFREQ; Si549: registers, small change.
+int
+UsbAvrGetBench(UsbAvr_t* dev, uint16_t mhz, uint16_t khz, uint16_t cycles[4])
+{
+	uint8_t		reply[8];
+	int			n = In(dev, CMD_GET_BENCH, mhz, khz, reply, sizeof(reply));
+	uint8_t		i;
+
+	if (n > 0 && cycles != NULL)
+		for (i = 0; i < 4; ++i)
+			cycles[i] = Get16(&reply[2 * i]);
+	return n;
+}
+
+//---- Command list
+
+void
+UsbAvrListInit(UsbAvrList_t* list)
+{
+	list->len = 0;
+	list->count = 0;
+}
+
+// Add a record, a command with data is a OUT command in the firmware.
+// Return USBAVR_ERROR when the record does not fit.
+int
+UsbAvrListAdd(UsbAvrList_t* list, uint8_t request, uint16_t value, uint16_t index, const void* data, uint8_t len)
+{
+	uint8_t*	rec = &list->data[list->len];
+
+	if (len > 8 || list->len + USBAVR_LIST_HEADER + len > USBAVR_LIST_SIZE)
+		return USBAVR_ERROR;
+
+	rec[0] = request;
+	Put16(&rec[1], value);
+	Put16(&rec[3], index);
+	rec[5] = len;
+	if (len != 0)
+		memcpy(&rec[USBAVR_LIST_HEADER], data, len);
+
+	list->len += USBAVR_LIST_HEADER + len;
+	list->count++;
+	return 0;
+}
+
+int
+UsbAvrListAddFreq(UsbAvrList_t* list, double mhz)
+{
+	uint8_t		data[4];
+
+	Put32(data, UsbAvrTo11_21(mhz));
+	return UsbAvrListAdd(list, CMD_SET_FREQ, 0, 0, data, sizeof(data));
+}
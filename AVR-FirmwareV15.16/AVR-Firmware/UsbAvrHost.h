@@ -0,0 +1,154 @@
+//************************************************************************
+//**
+//** Project......: Firmware USB AVR Si570 controler.
+//**
+//** Platform.....: Host PC (gcc), not the AVR chip
+//**
+//** Licence......: This software is freely available for non-commercial
+//**                use - i.e. for research and experimentation only!
+//**
+//** Programmer...: F.W. Krom, PE0FKO
+//**
+//** Description..: Host library of the USB commands of usbavrcmd.h.
+//**                A command is a vendor control transfer, done by the
+//**                transport of the device:
+//**                UsbAvrLibusb.c  libusb-1.0, the firmware on the AVR chip.
+//**                UsbAvrSim.c     a host build of the firmware, the setup
+//**                                packet goes to usbFunctionSetup() and the
+//**                                data to usbFunctionWrite() as V-USB does.
+//**                The functions return the bytes of the reply, or a
+//**                negative value on a transfer error. The frequencies are
+//**                in MHz, converted to the fixed point of the firmware:
+//**                frequency and step [11.21], xtal [8.24], filter cross
+//**                over [11.5]. The commands the firmware does not have
+//**                (0x11, 0x1A, 0x1B, 0x3E, Mobo 0x60..0x6F) go with
+//**                UsbAvrCommand(), the firmware returns 0xFF.
+//**
+//** History......: Check the main.c file
+//**
+//**************************************************************************
+
+#ifndef _PE0FKO_USB_AVR_HOST_H_
+#define _PE0FKO_USB_AVR_HOST_H_ 1
+
+#include <stdint.h>
+#include "usbavrcmd.h"
+
+#define	USBAVR_VID				0x16c0		// voti.nl / obdev.at shared VID
+#define	USBAVR_PID				0x05dc		// Vendor class device
+#define	USBAVR_VENDOR			"www.obdev.at"
+#define	USBAVR_PRODUCT			"DG8SAQ-I2C"
+
+#define	USBAVR_ERROR			-1			// Transfer error, or the device is not found
+#define	USBAVR_SHORT			-2			// Reply shorter than the command has, not supported
+
+#define	USBAVR_IN				1			// Device to host, the reply in data
+#define	USBAVR_OUT				0			// Host to device, the data of the command
+
+#define	USBAVR_LIST_SIZE		32			// CMD_SET_LIST size of the ATmega, 16 on the ATtiny
+#define	USBAVR_LIST_HEADER		6			// Record: cmd, wValue, wIndex, len
+
+typedef struct {
+	void*		handle;						// Device of the transport
+	int			(*control)(void* handle, uint8_t dir, uint8_t request,
+					uint16_t value, uint16_t index, uint8_t* data, uint16_t len);
+	void		(*close)(void* handle);
+} UsbAvr_t;
+
+typedef struct {							// Records of a CMD_SET_LIST
+	uint8_t		data[USBAVR_LIST_SIZE];
+	uint8_t		len;
+	uint8_t		count;						// Records in the list
+} UsbAvrList_t;
+
+//---- Transports, return 0 when the device is open
+
+extern	int			UsbAvrOpenLibusb(UsbAvr_t* dev, const char* serial);	// serial NULL: first "PE0FKO-x"
+extern	int			UsbAvrOpenSim(UsbAvr_t* dev);
+extern	void		UsbAvrClose(UsbAvr_t* dev);
+
+//---- Fixed point conversion
+
+extern	uint32_t	UsbAvrTo11_21(double mhz);
+extern	double		UsbAvrFrom11_21(uint32_t value);
+extern	uint32_t	UsbAvrTo8_24(double mhz);
+extern	double		UsbAvrFrom8_24(uint32_t value);
+extern	uint16_t	UsbAvrTo11_5(double mhz);
+extern	double		UsbAvrFrom11_5(uint16_t value);
+
+//---- Commands
+
+extern	int			UsbAvrCommand(UsbAvr_t* dev, uint8_t dir, uint8_t request,
+						uint16_t value, uint16_t index, uint8_t* data, uint16_t len);
+
+extern	int			UsbAvrGetVersion(UsbAvr_t* dev, uint16_t* version);					// 0x00
+extern	int			UsbAvrSetDdr(UsbAvr_t* dev, uint8_t ddr);							// 0x01
+extern	int			UsbAvrGetPin(UsbAvr_t* dev, uint8_t* pin);							// 0x02
+extern	int			UsbAvrGetPort(UsbAvr_t* dev, uint8_t* port);							// 0x03
+extern	int			UsbAvrSetPort(UsbAvr_t* dev, uint8_t port);							// 0x04
+extern	int			UsbAvrReboot(UsbAvr_t* dev);											// 0x0F
+extern	int			UsbAvrSetIo(UsbAvr_t* dev, uint8_t mask, uint8_t data, uint16_t* io);	// 0x15
+extern	int			UsbAvrGetIo(UsbAvr_t* dev, uint16_t* io);							// 0x16
+extern	int			UsbAvrSetFilter(UsbAvr_t* dev, uint8_t index, uint16_t value,
+						uint16_t crossOver[4]);												// 0x17
+extern	int			UsbAvrSetRxBandFilter(UsbAvr_t* dev, uint8_t band, uint8_t filter,
+						uint8_t filters[4]);												// 0x18
+extern	int			UsbAvrGetRxBandFilter(UsbAvr_t* dev, uint8_t filters[4]);			// 0x19
+extern	int			UsbAvrSetChipReg(UsbAvr_t* dev, uint8_t reg, uint8_t data,
+						uint8_t* i2cErrors);												// 0x20
+extern	int			UsbAvrSetFreqReg(UsbAvr_t* dev, const uint8_t reg[6]);				// 0x30
+extern	int			UsbAvrSetLoSm(UsbAvr_t* dev, uint8_t band, double sub, double mul);	// 0x31
+extern	int			UsbAvrSetFreq(UsbAvr_t* dev, double mhz);							// 0x32
+extern	int			UsbAvrSetXtal(UsbAvr_t* dev, double mhz);							// 0x33
+extern	int			UsbAvrSetStartup(UsbAvr_t* dev, double mhz);							// 0x34
+extern	int			UsbAvrSetPpm(UsbAvr_t* dev, uint16_t ppm);							// 0x35
+extern	int			UsbAvrGetLoSm(UsbAvr_t* dev, uint8_t band, double* sub, double* mul);	// 0x39
+extern	int			UsbAvrGetFreq(UsbAvr_t* dev, double* mhz);							// 0x3A
+extern	int			UsbAvrGetPpm(UsbAvr_t* dev, uint16_t* ppm);							// 0x3B
+extern	int			UsbAvrGetStartup(UsbAvr_t* dev, double* mhz);						// 0x3C
+extern	int			UsbAvrGetXtal(UsbAvr_t* dev, double* mhz);							// 0x3D
+extern	int			UsbAvrGetChipRegs(UsbAvr_t* dev, uint8_t index, uint8_t reg[11]);	// 0x3F
+extern	int			UsbAvrGetI2CErrors(UsbAvr_t* dev, uint8_t* i2cErrors);				// 0x40
+extern	int			UsbAvrSetI2CAddr(UsbAvr_t* dev, uint8_t addr, uint8_t* old);			// 0x41
+extern	int			UsbAvrGetCpuTemp(UsbAvr_t* dev, uint16_t* adc);						// 0x42
+extern	int			UsbAvrSetUsbId(UsbAvr_t* dev, uint8_t id, uint8_t* old);				// 0x43
+extern	int			UsbAvrSetGrade(UsbAvr_t* dev, uint8_t grade, uint8_t rfreqIndex,
+						uint16_t dco, uint8_t reply[6]);									// 0x44
+extern	int			UsbAvrGetChipInfo(UsbAvr_t* dev, uint8_t* chip, uint8_t* grade,
+						double* xtal);														// 0x45
+extern	int			UsbAvrGetI2CStatus(UsbAvr_t* dev, uint8_t* queued, uint8_t* i2cErrors);	// 0x46
+extern	int			UsbAvrSetSweep(UsbAvr_t* dev, double start, double step,
+						uint16_t count, uint16_t dwell);									// 0x47
+extern	int			UsbAvrGetSweep(UsbAvr_t* dev, uint16_t* count, double* mhz);			// 0x48
+extern	int			UsbAvrEepromCommit(UsbAvr_t* dev, uint8_t commit, uint8_t* dirty);	// 0x49
+extern	int			UsbAvrGetEepromCrc(UsbAvr_t* dev, uint8_t* version, uint16_t* crc,
+						uint8_t* state);													// 0x4A
+extern	int			UsbAvrSetList(UsbAvr_t* dev, const UsbAvrList_t* list);				// 0x4B
+extern	int			UsbAvrGetList(UsbAvr_t* dev, uint8_t* reply, uint16_t len);			// 0x4C
+extern	int			UsbAvrSetKeyer(UsbAvr_t* dev, uint8_t mode, uint8_t wpm, uint8_t weight);	// 0x4D
+extern	int			UsbAvrGetKeyer(UsbAvr_t* dev, uint8_t* mode, uint8_t* wpm, uint8_t* weight);	// 0x4E
+extern	int			UsbAvrSetTempComp(UsbAvr_t* dev, uint8_t index, uint16_t adc, int16_t xtal);	// 0x4F
+extern	int			UsbAvrSetPtt(UsbAvr_t* dev, uint8_t on, uint8_t* keys);				// 0x50
+extern	int			UsbAvrGetCwKey(UsbAvr_t* dev, uint8_t* keys);						// 0x51
+extern	int			UsbAvrConfig(UsbAvr_t* dev, uint8_t set, uint8_t clear, uint8_t* flags);	// 0x55
+extern	int			UsbAvrGetTempComp(UsbAvr_t* dev, uint8_t index, uint16_t* adc, int16_t* xtal,
+						uint16_t* filter, int16_t* corr);									// 0x56
+extern	int			UsbAvrSetEncoder(UsbAvr_t* dev, uint8_t index, double step);			// 0x57
+extern	int			UsbAvrGetEncoder(UsbAvr_t* dev, uint8_t index, double* step);		// 0x58
+extern	int			UsbAvrGetProfile(UsbAvr_t* dev, uint16_t counters[15]);				// 0x59, last, min, max
+extern	int			UsbAvrResetProfile(UsbAvr_t* dev);									// 0x5A
+extern	int			UsbAvrSetHop(UsbAvr_t* dev, uint8_t index, double mhz, uint16_t dwell);	// 0x5B
+extern	int			UsbAvrStartHop(UsbAvr_t* dev, uint8_t count, uint8_t loops);			// 0x5C
+extern	int			UsbAvrGetHop(UsbAvr_t* dev, uint8_t* entry, uint8_t* loops, uint16_t* ms);	// 0x5D
+extern	int			UsbAvrGetImageCache(UsbAvr_t* dev, uint8_t clear, uint16_t* hits,
+						uint16_t* misses, uint8_t* used);									// 0x5E
+extern	int			UsbAvrGetBench(UsbAvr_t* dev, uint16_t mhz, uint16_t khz, uint16_t cycles[4]);	// 0x5F
+
+//---- Command list, the records are done by the firmware in one CMD_SET_LIST
+
+extern	void		UsbAvrListInit(UsbAvrList_t* list);
+extern	int			UsbAvrListAdd(UsbAvrList_t* list, uint8_t request, uint16_t value,
+						uint16_t index, const void* data, uint8_t len);
+extern	int			UsbAvrListAddFreq(UsbAvrList_t* list, double mhz);
+
+#endif
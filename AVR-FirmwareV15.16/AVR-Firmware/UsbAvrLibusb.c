@@ -0,0 +1,121 @@
+//************************************************************************
+//**
+//** Project......: Firmware USB AVR Si570 controler.
+//**
+//** Platform.....: Host PC (gcc), not the AVR chip
+//**
+//** Licence......: This software is freely available for non-commercial
+//**                use - i.e. for research and experimentation only!
+//**
+//** Programmer...: F.W. Krom, PE0FKO
+//**
+//** Description..: Transport of UsbAvrHost.h to the firmware on the AVR
+//**                chip with libusb-1.0. The device is found by the VID /
+//**                PID and the strings of usbconfig.h, the vendor
+//**                "www.obdev.at" and product "DG8SAQ-I2C". A serial number
+//**                selects one of more devices, "PE0FKO-x" with x the USB
+//**                id of command 0x43.
+//**                Build with: $(pkg-config --cflags --libs libusb-1.0)
+//**
+//** History......: Check the main.c file
+//**
+//**************************************************************************
+
+#include <stdlib.h>
+#include <string.h>
+#include <libusb.h>
+#include "UsbAvrHost.h"
+
+#define	USB_TIMEOUT_MS		500				// Control transfer timeout
+
+static	libusb_context*		UsbContext;
+static	uint8_t				UsbOpen;			// Devices open in the context
+
+static int
+UsbControl(void* handle, uint8_t dir, uint8_t request,
+	uint16_t value, uint16_t index, uint8_t* data, uint16_t len)
+{
+	int		n;
+
+	n = libusb_control_transfer((libusb_device_handle*)handle,
+			LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE |
+			(dir == USBAVR_IN ? LIBUSB_ENDPOINT_IN : LIBUSB_ENDPOINT_OUT),
+			request, value, index, data, len, USB_TIMEOUT_MS);
+
+	return n < 0 ? USBAVR_ERROR : n;
+}
+
+static void
+UsbClose(void* handle)
+{
+	libusb_close((libusb_device_handle*)handle);
+
+	if (--UsbOpen == 0)
+	{
+		libusb_exit(UsbContext);
+		UsbContext = NULL;
+	}
+}
+
+// True when the string descriptor index is the text.
+static int
+UsbString(libusb_device_handle* h, uint8_t index, const char* text)
+{
+	unsigned char	s[64];
+
+	return index != 0
+		&& libusb_get_string_descriptor_ascii(h, index, s, sizeof(s)) > 0
+		&& strcmp((const char*)s, text) == 0;
+}
+
+// Open the first device with the VID / PID and the vendor and product
+// strings, and the serial number when it is not NULL.
+int
+UsbAvrOpenLibusb(UsbAvr_t* dev, const char* serial)
+{
+	libusb_device**					list;
+	libusb_device_handle*			found = NULL;
+	struct libusb_device_descriptor	desc;
+	ssize_t							count;
+	ssize_t							i;
+
+	if (UsbContext == NULL && libusb_init(&UsbContext) < 0)
+		return USBAVR_ERROR;
+
+	count = libusb_get_device_list(UsbContext, &list);
+	for (i = 0; i < count && found == NULL; ++i)
+	{
+		libusb_device_handle*	h;
+
+		if (libusb_get_device_descriptor(list[i], &desc) < 0
+		||	desc.idVendor != USBAVR_VID
+		||	desc.idProduct != USBAVR_PID
+		||	libusb_open(list[i], &h) < 0)
+			continue;
+
+		if (UsbString(h, desc.iManufacturer, USBAVR_VENDOR)
+		&&	UsbString(h, desc.iProduct, USBAVR_PRODUCT)
+		&&	(serial == NULL || UsbString(h, desc.iSerialNumber, serial)))
+			found = h;
+		else
+			libusb_close(h);
+	}
+	if (count >= 0)
+		libusb_free_device_list(list, 1);
+
+	if (found == NULL)
+	{
+		if (UsbOpen == 0)
+		{
+			libusb_exit(UsbContext);
+			UsbContext = NULL;
+		}
+		return USBAVR_ERROR;
+	}
+
+	UsbOpen++;
+	dev->handle = found;
+	dev->control = UsbControl;
+	dev->close = UsbClose;
+	return 0;
+}
@@ -0,0 +1,366 @@
+//************************************************************************
+//**
+//** Project......: Firmware USB AVR Si570 controler.
+//**
+//** Platform.....: Host PC (gcc), not the AVR chip
+//**
+//** Licence......: This software is freely available for non-commercial
+//**                use - i.e. for research and experimentation only!
+//**
+//** Programmer...: F.W. Krom, PE0FKO
+//**
+//** Description..: Transport of UsbAvrHost.h to a host build of the
+//**                firmware, no USB. The control transfer is done as V-USB
+//**                does it: the setup packet to usbFunctionSetup(), the OUT
+//**                data in 8 byte packets to usbFunctionWrite(), the IN reply
+//**                from usbMsgPtr. After every transfer the pollers of the
+//**                main loop run until the I2C queue is empty.
+//**                The firmware is main.c (only the USB functions on the
+//**                host), the device file, CalcVFO.c, I2CQueue.c, Eeprom.c,
+//**                CmdList.c, Sweep.c, TempComp.c and for the ATmega Hop.c
+//**                and ImageCache.c. The I2C chip is a register file: the
+//**                writes are kept and read back, the Si570 RECALL loads
+//**                the factory 100 MHz and NewFreq is always done. The eeprom
+//**                is ram, it keeps the settings over a CMD_REBOOT.
+//**                One firmware in a program, the device of the build:
+//**                  -DDEVICE_SI570 or -DDEVICE_SI549 (default Si570),
+//**                  -D__AVR_ATmega328P__ for the ATmega, else the ATtiny85.
+//**
+//** History......: Check the main.c file
+//**
+//**************************************************************************
+
+#if !defined(DEVICE_SI570) && !defined(DEVICE_SI549)
+#define	DEVICE_SI570
+#endif
+
+#include <stdio.h>
+#include <time.h>
+#include "main.c"
+#if defined(DEVICE_SI570)
+#include "DeviceSi570.c"
+#else
+#include "DeviceSi549.c"
+#endif
+#include "CalcVFO.c"
+#include "I2CQueue.c"
+#include "FreqFromSi570.c"
+#include "Eeprom.c"
+#include "CmdList.c"
+#include "Sweep.c"
+#include "TempComp.c"
+#include "Hop.c"
+#include "ImageCache.c"
+#include "UsbAvrHost.h"
+
+#define	SIM_TEMPERATURE		300					// ADC value of GetTemperature()
+#define	SIM_PACKET			8					// V-USB data packet of a low speed device
+
+volatile uint8_t	DDRB, PORTB, PINB;
+uchar*				usbMsgPtr;
+uint32_t			EventFreq;
+
+static	uint8_t		SimEeprom[E2END + 1];
+static	var_t		SimDefaults;				// R of the flash, loaded at every boot
+static	uint8_t		SimFlash;					// SimDefaults is set
+static	uint8_t		SimOpen;
+
+//-------------------------------------------------------------------------
+//---- Eeprom in ram, E is at address 0 as on the AVR
+//-------------------------------------------------------------------------
+
+static uint8_t*
+SimEepromAddr(const void* addr)
+{
+	uintptr_t	a = (uintptr_t)addr;
+
+	if (a >= (uintptr_t)&E && a < (uintptr_t)&E + sizeof(E))
+		a -= (uintptr_t)&E;
+
+	return &SimEeprom[a & E2END];
+}
+
+uint8_t
+eeprom_read_byte(const uint8_t* addr)
+{
+	return *SimEepromAddr(addr);
+}
+
+void
+eeprom_read_block(void* dst, const void* src, size_t n)
+{
+	while (n--)
+		*(uint8_t*)dst++ = eeprom_read_byte(src++);
+}
+
+void
+eeprom_write_byte(uint8_t* addr, uint8_t value)
+{
+	*SimEepromAddr(addr) = value;
+}
+
+void
+eeprom_write_word(uint16_t* addr, uint16_t value)
+{
+	eeprom_write_block(&value, addr, sizeof(value));
+}
+
+void
+eeprom_write_block(const void* src, void* dst, size_t n)
+{
+	while (n--)
+		eeprom_write_byte(dst++, *(const uint8_t*)src++);
+}
+
+//-------------------------------------------------------------------------
+//---- I2C chip, a register file
+//-------------------------------------------------------------------------
+
+enum { I2C_IDLE, I2C_ADDR, I2C_REG, I2C_WRITE, I2C_READ };
+
+uint8_t		I2CErrors;
+
+static	uint8_t		SimReg[256];				// Registers of the chip
+#if defined(DEVICE_SI570)
+static	uint8_t		SimRegFactory[6];			// Si570 reg 7..12 of the RECALL
+#endif
+static	uint8_t		SimI2CState;
+static	uint8_t		SimI2CReg;					// Register pointer
+
+static void
+SimChipReset(void)
+{
+	memset(SimReg, 0, sizeof(SimReg));
+#if defined(DEVICE_SI570)
+	{
+		static const uint8_t	signature[] = { 0x07, 0xC2, 0xC0, 0x00, 0x00, 0x00 };
+		uint64_t	rfreq = (uint64_t)(5000.0 / 114.285 * _2(28));
+
+		// Factory startup 100 MHz, DCO 5000 MHz, HS_DIV 5, N1 10
+		SimRegFactory[0] = ((5 - 4) << 5) | ((10 - 1) >> 2);
+		SimRegFactory[1] = ((10 - 1) & 0x03) << 6 | (uint8_t)(rfreq >> 32);
+		SimRegFactory[2] = rfreq >> 24;
+		SimRegFactory[3] = rfreq >> 16;
+		SimRegFactory[4] = rfreq >> 8;
+		SimRegFactory[5] = rfreq;
+		memcpy(&SimReg[7], SimRegFactory, sizeof(SimRegFactory));
+		memcpy(&SimReg[13], signature, sizeof(signature));	// 50 / 20 ppm chip, RFREQ index 7
+	}
+#endif
+}
+
+static void
+SimChipWrite(uint8_t reg, uint8_t data)
+{
+#if defined(DEVICE_SI570)
+	if (reg == 135)
+	{
+		if (data & (1<<0))						// RECALL
+			memcpy(&SimReg[7], SimRegFactory, sizeof(SimRegFactory));
+		data &= ~((1<<6) | (1<<0));				// NewFreq and RECALL are done at once
+	}
+#endif
+	SimReg[reg] = data;
+}
+
+void
+I2CSendStart(void)
+{
+	I2CErrors = 0;
+	SimI2CState = I2C_ADDR;
+}
+
+void
+I2CSendStop(void)
+{
+	SimI2CState = I2C_IDLE;
+}
+
+void
+I2CSendByte(uint8_t b)
+{
+	switch (SimI2CState)
+	{
+		case I2C_ADDR:
+			if ((b >> 1) != R.ChipCrtlData)
+			{
+				I2CErrors = 1;					// No acknowledge of the address
+				SimI2CState = I2C_IDLE;
+			}
+			else
+				SimI2CState = (b & 1) ? I2C_READ : I2C_REG;
+			break;
+		case I2C_REG:
+			SimI2CReg = b;
+			SimI2CState = I2C_WRITE;
+			break;
+		case I2C_WRITE:
+			SimChipWrite(SimI2CReg++, b);
+			break;
+		default:
+			I2CErrors = 1;
+			break;
+	}
+}
+
+uint8_t
+I2CReceiveByte(void)
+{
+	return SimI2CState == I2C_READ ? SimReg[SimI2CReg++] : 0xFF;
+}
+
+void	I2CSend0(void)			{ }
+void	I2CSend1(void)			{ }
+
+//-------------------------------------------------------------------------
+//---- The rest of the AVR
+//-------------------------------------------------------------------------
+
+uint16_t
+TimerGetTicks(void)
+{
+	struct timespec	t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint16_t)(t.tv_sec * 1000 + t.tv_nsec / 1000000);
+}
+
+uint16_t
+GetTemperature(void)
+{
+	return SIM_TEMPERATURE;
+}
+
+void
+KeyerInit(void)
+{
+}
+
+void
+EventAdd(uint8_t cmd, uint32_t data)
+{
+	if (cmd == INTR_CMD_FREQ_CHANGE)
+		EventFreq = data;
+}
+
+// The pollers of the main loop of main.c, until the I2C writes are done.
+static void
+SimPoll(void)
+{
+	do {
+		I2CQueuePoll();
+		SweepPoll();
+		EepromPoll();
+		TempCompPoll();
+#if INCLUDE_HOP
+		HopPoll();
+#endif
+		DeviceOnline();
+	} while (I2CQueueCount != 0);
+}
+
+// The start of main() of main.c, the ram is loaded from the flash.
+static void
+SimBoot(void)
+{
+	R = SimDefaults;
+	PINB = _BV(BIT_SCL);						// SCL high, the chip has power
+
+	EepromLoad();
+	DeviceInit();
+	DeviceOnline();
+
+	usbDescriptorStringSerialNumber[
+		sizeof(usbDescriptorStringSerialNumber)/sizeof(int)-1] = R.SerialNumber;
+
+	KeyerInit();
+	SimPoll();
+}
+
+//-------------------------------------------------------------------------
+//---- Transport
+//-------------------------------------------------------------------------
+
+static int
+SimControl(void* handle, uint8_t dir, uint8_t request,
+	uint16_t value, uint16_t index, uint8_t* data, uint16_t len)
+{
+	usbRequest_t	rq;
+	usbMsgLen_t		n;
+	int				result;
+	uint16_t		pos;
+	uint8_t			size;
+	uint8_t			done;
+
+	(void)handle;
+
+	if (request == CMD_REBOOT)					// The firmware waits for the watchdog
+	{
+		EepromFlush();
+		SimBoot();
+		return 0;
+	}
+
+	rq.bmRequestType = USBRQ_TYPE_VENDOR | (dir == USBAVR_IN ? USBRQ_DIR_DEVICE_TO_HOST : USBRQ_DIR_HOST_TO_DEVICE);
+	rq.bRequest = request;
+	rq.wValue.word = value;
+	rq.wIndex.word = index;
+	rq.wLength.word = len;
+
+	n = usbFunctionSetup((uchar*)&rq);
+
+	if (n == USB_NO_MSG)
+	{
+		if (dir == USBAVR_IN)
+			return USBAVR_ERROR;				// No usbFunctionRead() in the firmware
+
+		done = len == 0;
+		for (pos = 0; !done && pos < len; pos += size)
+		{
+			size = len - pos < SIM_PACKET ? len - pos : SIM_PACKET;
+			done = usbFunctionWrite(&data[pos], size);
+			if (done == 0xFF)
+				return USBAVR_ERROR;			// Stall
+		}
+		result = done ? pos : USBAVR_ERROR;
+	}
+	else
+	if (dir == USBAVR_IN)
+	{
+		result = n < len ? n : len;
+		memcpy(data, usbMsgPtr, result);
+	}
+	else
+		result = 0;
+
+	SimPoll();
+	return result;
+}
+
+static void
+SimClose(void* handle)
+{
+	(void)handle;
+	SimOpen = false;
+}
+
+// Power up of the firmware with a empty eeprom, only one device.
+int
+UsbAvrOpenSim(UsbAvr_t* dev)
+{
+	if (SimOpen)
+		return USBAVR_ERROR;
+
+	if (!SimFlash)
+		SimDefaults = R;
+	SimFlash = true;
+	SimOpen = true;
+	memset(SimEeprom, 0xFF, sizeof(SimEeprom));
+	SimChipReset();
+	SimBoot();
+
+	dev->handle = NULL;
+	dev->control = SimControl;
+	dev->close = SimClose;
+	return 0;
+}
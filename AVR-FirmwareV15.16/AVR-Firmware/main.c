@@ -65,6 +65,7 @@
 //**                                  support the change of RFREQ index.
 //**                                  Also removed some global register variables to normal ram.
 //**               V15.16 01/04/2018: Si549 chip from SiLabs extention.
+//**               V15.17 17/10/2026: Speed and function extensions, commands 0x45..0x5F, see Readme.txt.
 //**                                  
 //**************************************************************************
 //
@@ -146,7 +147,7 @@
 #include "main.h"
 
 // Programming fuses and lockbits
-#if defined( __AVR_ATtiny45__ ) | defined( __AVR_ATtiny85__ )
+#if defined(__AVR__) && (defined( __AVR_ATtiny45__ ) | defined( __AVR_ATtiny85__ ))
 
 // The programming of the RSTDISBL is not working correct with my AVRISP-MKII
 FUSES = { 
@@ -162,13 +163,14 @@ LOCKBITS = (LB_MODE_1);
 		sint16_t	replyBuf[4];				// USB Reply buffer
 static	uint8_t		bIndex;
 static	uint8_t		usbRequest;					// usbFunctionWrite command
-
-#if INCLUDE_INTERRUPT							// Include the usb interrupt code
-		intrBuf_t	intrBufIO	= { .cmd=INTR_CMD_IO_CHANGE,	.x.io.data=0 };
-		intrBuf_t	intrBufFreq	= { .cmd=INTR_CMD_FREQ_CHANGE,	.x.io.data=0 };
+#if INCLUDE_SWEEP
+static	uint16_t	usbValue;					// usbFunctionWrite wValue
+static	uint16_t	usbIndex;					// usbFunctionWrite wIndex
 #endif
 
+#if defined(__AVR__)
 EMPTY_INTERRUPT( __vector_default );			// Redirect all unused interrupts to reti
+#endif
 
 int	usbDescriptorStringSerialNumber[] = {
     USB_STRING_DESCRIPTOR_HEADER(USB_CFG_SERIAL_NUMBER_LEN),
@@ -184,7 +186,9 @@ uchar usbFunctionWrite(uchar *data, uchar len) //sends len bytes to SI570
 	SWITCH_START(usbRequest)
 
 	SWITCH_CASE(CMD_SET_FREQ_REG)
-		if (len == sizeof(Si_Reg_t)) {
+		if (len == SI_REG_SIZE) {
+			SweepStop();
+			HopStop();
 			CalcFreqFromRegSi570(data);			// Calc the freq from the Si570 register value
 			SetFreq(*(uint32_t*)data, 0);			// and call the SetFreq(..) with the freq!
 		}
@@ -193,14 +197,16 @@ uchar usbFunctionWrite(uchar *data, uchar len) //sends len bytes to SI570
 		if (len == 2*sizeof(uint32_t)) {
 			bIndex &= MAX_RX_BAND-1;
 			memcpy(&R.Band2Subtract[bIndex], &data[0], sizeof(uint32_t));
-			eeprom_write_block(&data[0], &E.Band2Subtract[bIndex], sizeof(uint32_t));
+			EepromWrite(&R.Band2Subtract[bIndex], sizeof(uint32_t));
 			memcpy(&R.Band2Multiply[bIndex], &data[4], sizeof(uint32_t));
-			eeprom_write_block(&data[4], &E.Band2Multiply[bIndex], sizeof(uint32_t));
+			EepromWrite(&R.Band2Multiply[bIndex], sizeof(uint32_t));
 		}
 
 
 	SWITCH_CASE(CMD_SET_FREQ)					// Set frequency by value and load Si570
 		if (len == sizeof(uint32_t)) {
+			SweepStop();
+			HopStop();
 			SetFreq(*(uint32_t*)data, bIndex);	// Set freq [11.21], with bIndex [11.29]
 		}
 
@@ -208,21 +214,72 @@ uchar usbFunctionWrite(uchar *data, uchar len) //sends len bytes to SI570
 	SWITCH_CASE(CMD_SET_XTAL)					// write new crystal frequency to EEPROM and use it.
 		if (len == sizeof(R.FreqXtal)) {
 			R.FreqXtal = *(uint32_t*)data;
-			eeprom_write_block(data, &E.FreqXtal, sizeof(E.FreqXtal));
+			EepromWrite(&R.FreqXtal, sizeof(R.FreqXtal));
+			ImageCacheFlush();					// Registers of the old xtal
+			HopRecalc();
 		}
 
 
 	SWITCH_CASE(CMD_SET_STARTUP)				// Write new startup frequency to eeprom
 		if (len == sizeof(R.Freq)) {
-			eeprom_write_block(data, &E.Freq, sizeof(E.Freq));
+			EepromSetStartup(*(uint32_t*)data);
 		}
 
 
 	SWITCH_CASE(CMD_SET_PPM)					// Write new smooth tune to eeprom and use it.
 		if (len == sizeof(R.SmoothTunePPM)) {
 			R.SmoothTunePPM = *(uint16_t*)data;
-			eeprom_write_block(data, &E.SmoothTunePPM, sizeof(E.SmoothTunePPM));
+			EepromWrite(&R.SmoothTunePPM, sizeof(R.SmoothTunePPM));
+		}
+
+
+#if INCLUDE_SWEEP
+	SWITCH_CASE(CMD_SET_SWEEP)					// Start frequency and step [11.21]
+		if (len == 2*sizeof(uint32_t)) {
+			SweepStart(((uint32_t*)data)[0], ((uint32_t*)data)[1], usbValue, usbIndex);
+		}
+#endif
+
+
+#if INCLUDE_TEMP_COMP
+	SWITCH_CASE(CMD_SET_TEMP_COMP)				// Temperature and xtal correction of point bIndex
+		if (len == 2*sizeof(uint16_t)) {
+			bIndex &= TEMP_COMP_POINTS-1;
+			memcpy(&R.TempCompTemp[bIndex], &data[0], sizeof(R.TempCompTemp[0]));
+			EepromWrite(&R.TempCompTemp[bIndex], sizeof(R.TempCompTemp[0]));
+			memcpy(&R.TempCompXtal[bIndex], &data[2], sizeof(R.TempCompXtal[0]));
+			EepromWrite(&R.TempCompXtal[bIndex], sizeof(R.TempCompXtal[0]));
+		}
+#endif
+
+
+#if INCLUDE_HOP
+	SWITCH_CASE(CMD_SET_HOP)					// Hop entry bIndex, frequency [11.21] and dwell [ms]
+		if (len == sizeof(uint32_t) + sizeof(uint16_t)) {
+			HopSetEntry(bIndex, ((uint32_t*)data)[0], ((uint16_t*)data)[2]);
+		}
+#endif
+
+
+#if INCLUDE_ENCODER
+	SWITCH_CASE(CMD_SET_ENCODER)				// Encoder step [11.21] of table index bIndex
+		if (len == sizeof(uint32_t)) {
+			uint32_t	step;
+
+			memcpy(&step, data, sizeof(step));
+			if (step != 0 && step <= ENCODER_STEP_MAX) {	// A step out of range is not used
+				bIndex &= ENCODER_STEPS-1;
+				R.EncoderStep[bIndex] = step;
+				EepromWrite(&R.EncoderStep[bIndex], sizeof(R.EncoderStep[0]));
+			}
 		}
+#endif
+
+
+#if INCLUDE_CMD_LIST
+	SWITCH_CASE(CMD_SET_LIST)					// Collect the command list, done with the last part
+		return CmdListWrite(data, len);
+#endif
 
 
 	SWITCH_END
@@ -279,6 +336,7 @@ usbFunctionSetup(uchar data[8])
 
 
 	SWITCH_CASE(CMD_REBOOT)						// Watchdog reset
+		EepromFlush();							// First the changed settings
 		while(true) ;
 
 //////////////////////////////////////////////////////////////////////////////////////////////////
@@ -318,9 +376,7 @@ usbFunctionSetup(uchar data[8])
 			{
 				R.Band2CrossOver[index].w = rq->wValue.word;
 
-				eeprom_write_block(&R.Band2CrossOver[index].w, 
-						&E.Band2CrossOver[index].w, 
-						sizeof(E.Band2CrossOver[0].w));
+				EepromWrite(&R.Band2CrossOver[index].w, sizeof(R.Band2CrossOver[0].w));
 
 				// Set also the ConfigFlags
 				if (index == (MAX_RX_BAND-1))
@@ -331,7 +387,7 @@ usbFunctionSetup(uchar data[8])
 					else
 						R.ConfigFlags &= ~CONFIG_ABPF;
 
-					eeprom_write_byte(&E.ConfigFlags, R.ConfigFlags);
+					EepromWrite(&R.ConfigFlags, sizeof(R.ConfigFlags));
 				}
 			}
 
@@ -347,6 +403,10 @@ usbFunctionSetup(uchar data[8])
 		// Also for the Si549, do we need this still?
 	SWITCH_CASE(CMD_SET_SI570)					// [DEBUG] Write byte to Si570 register
 		Si_CmdReg(rq->wValue.bytes[1], rq->wIndex.bytes[0]);
+		I2CQueueFlush();
+#if defined(DEVICE_SI549)
+		Si549Page = SI549_PAGE_UNKNOWN;			// The page may be changed
+#endif
 		replyBuf[0].b0 = I2CErrors;				// return I2C transmission error status
         return sizeof(uint8_t);
 
@@ -362,6 +422,20 @@ usbFunctionSetup(uchar data[8])
 		return USB_NO_MSG;						// use usbFunctionWrite to transfer data
 
 
+#if INCLUDE_SWEEP
+	SWITCH_CASE(CMD_SET_SWEEP)					// Sweep count in wValue, dwell time [ms] in wIndex
+		usbValue = rq->wValue.word;
+		usbIndex = rq->wIndex.word;
+		if (usbValue == 0)						// Count zero, stop the sweep
+			SweepStop();
+		return USB_NO_MSG;						// use usbFunctionWrite to transfer data
+
+
+	SWITCH_CASE(CMD_GET_SWEEP)					// Return the sweep count and frequency
+		return SweepStatus((uint8_t*)replyBuf);
+#endif
+
+
 	SWITCH_CASE(CMD_GET_LO_SM)					// Return the frequency subtract multiply
 		uint8_t band = rq->wIndex.bytes[0] & (MAX_RX_BAND-1);	// 0..3 only
 		memcpy(&replyBuf[0].w, &R.Band2Subtract[band], sizeof(uint32_t));
@@ -380,7 +454,7 @@ usbFunctionSetup(uchar data[8])
 
 
 	SWITCH_CASE(CMD_GET_STARTUP)				// Return the startup frequency
-		eeprom_read_block(replyBuf, &E.Freq, sizeof(E.Freq));
+		*(uint32_t*)replyBuf = EepromGetStartup();
 		return sizeof(uint32_t);
 
 
@@ -400,15 +474,24 @@ usbFunctionSetup(uchar data[8])
 
 
 	SWITCH_CASE(CMD_GET_I2C_ERR)				// return I2C transmission error status
+		I2CQueueFlush();
 		replyBuf[0].b0 = I2CErrors;
 		return sizeof(uint8_t);
 
 
+#if INCLUDE_I2C_QUEUE
+	SWITCH_CASE(CMD_GET_I2C_STATUS)				// Queued I2C writes and error status, no wait
+		replyBuf[0].b0 = I2CQueueCount;
+		replyBuf[0].b1 = I2CErrors;
+		return sizeof(uint16_t);
+#endif
+
+
 	SWITCH_CASE(CMD_SET_I2C_ADDR)				// Set the new i2c address or factory default (pe0fko: function changed)
 		replyBuf[0].b0 = R.ChipCrtlData;		// Return the old I2C address (V15.12)
 		if (rq->wValue.bytes[0] != 0) {			// Only set if Value != 0
 			R.ChipCrtlData = rq->wValue.bytes[0];
-			eeprom_write_byte(&E.ChipCrtlData, R.ChipCrtlData);
+			EepromWrite(&R.ChipCrtlData, sizeof(R.ChipCrtlData));
 		}
 		return sizeof(R.ChipCrtlData);
 
@@ -419,11 +502,72 @@ usbFunctionSetup(uchar data[8])
 		return sizeof(uint16_t);
 #endif
 
+#if INCLUDE_TEMP_COMP
+	SWITCH_CASE(CMD_SET_TEMP_COMP)				// Table point index in wIndex
+		bIndex = rq->wIndex.bytes[0];
+		return USB_NO_MSG;						// use usbFunctionWrite to transfer data
+
+	SWITCH_CASE(CMD_GET_TEMP_COMP)				// Table point, filtered temperature and correction
+		return TempCompStatus((uint8_t*)replyBuf, rq->wIndex.bytes[0]);
+#endif
+
+#if INCLUDE_ENCODER
+	SWITCH_CASE(CMD_SET_ENCODER)				// Step table index in wIndex
+		bIndex = rq->wIndex.bytes[0];
+		return USB_NO_MSG;						// use usbFunctionWrite to transfer data
+
+	SWITCH_CASE(CMD_GET_ENCODER)				// Encoder step of table index wIndex
+		usbMsgPtr = (uint8_t*)&R.EncoderStep[rq->wIndex.bytes[0] & (ENCODER_STEPS-1)];
+		return sizeof(R.EncoderStep[0]);
+#endif
+
+#if INCLUDE_HOP
+	SWITCH_CASE(CMD_SET_HOP)					// Hop table entry in wIndex
+		bIndex = rq->wIndex.bytes[0];
+		return USB_NO_MSG;						// use usbFunctionWrite to transfer data
+
+	SWITCH_CASE(CMD_START_HOP)					// Hop the first wValue entries wIndex loops, 0 stops
+		HopStart(rq->wValue.bytes[0], rq->wIndex.bytes[0]);
+		return HopStatus((uint8_t*)replyBuf);
+
+	SWITCH_CASE(CMD_GET_HOP)					// Hop entry, loops to go and time to the next hop
+		return HopStatus((uint8_t*)replyBuf);
+#endif
+
+#if INCLUDE_IMAGE_CACHE
+	SWITCH_CASE(CMD_GET_IMAGE_CACHE)			// Cache hits and misses, clear them with wValue
+		return ImageCacheStatus((uint8_t*)replyBuf, rq->wValue.bytes[0]);
+#endif
+
+#if INCLUDE_PROFILE
+	SWITCH_CASE(CMD_GET_PROFILE)				// Profile counters, last, min and max
+		return ProfileGet();
+
+	SWITCH_CASE(CMD_RESET_PROFILE)				// Clear the profile counters
+		ProfileReset();
+		return 0;
+
+	SWITCH_CASE(CMD_GET_BENCH)					// CPU cycles of the frequency math
+	{
+		uint32_t	freq = (uint32_t)rq->wValue.word << 21;	// MHz to [11.21]
+		uint32_t	step = (uint32_t)rq->wIndex.word * 2097;	// kHz to [11.21]
+
+		memset(replyBuf, 0, sizeof(replyBuf));
+#if defined(DEVICE_SI570)
+		Si570Bench(&replyBuf[0].w, freq, step);
+#endif
+#if defined(DEVICE_SI549)
+		Si549Bench(&replyBuf[2].w, freq, step);
+#endif
+		return sizeof(replyBuf);
+	}
+#endif
+
 	SWITCH_CASE(CMD_GET_USB_ID)					// Get/Set the USB SeialNumber ID
 		replyBuf[0].b0 = R.SerialNumber;
 		if (rq->wValue.bytes[0] != 0) {			// Only set if Value != 0
 			R.SerialNumber = rq->wValue.bytes[0];
-			eeprom_write_byte(&E.SerialNumber, R.SerialNumber);
+			EepromWrite(&R.SerialNumber, sizeof(R.SerialNumber));
 		}
 		return sizeof(R.SerialNumber);
 
@@ -433,12 +577,13 @@ usbFunctionSetup(uchar data[8])
 		{
 			// Set Si570 grade (A,B,C) (Option code 3nd)
 			R.SiChipGrade = rq->wValue.bytes[0];
-			eeprom_write_byte(&E.SiChipGrade, R.SiChipGrade);
+			EepromWrite(&R.SiChipGrade, sizeof(R.SiChipGrade));
 
 			// Set the RFREQ register index, Option code 2nd
 			R.Si570RFREQIndex = rq->wValue.bytes[1];
-			eeprom_write_byte(&E.Si570RFREQIndex, R.Si570RFREQIndex);
+			EepromWrite(&R.Si570RFREQIndex, sizeof(R.Si570RFREQIndex));
 
+			ImageCacheFlush();					// Dividers of the old grade
 			DeviceInit();						// Initialize the Si5xx device
 			DeviceOnline();						//   and start it with default frequency
 		}
@@ -447,14 +592,16 @@ usbFunctionSetup(uchar data[8])
 			if (rq->wValue.bytes[1] == 0) 
 			{
 				R.SiChipDCOMin = rq->wIndex.word;
-				eeprom_write_word(&E.SiChipDCOMin, R.SiChipDCOMin);
+				EepromWrite(&R.SiChipDCOMin, sizeof(R.SiChipDCOMin));
 			}
 			else
 			{
 				R.SiChipDCOMax = rq->wIndex.word;
-				eeprom_write_word(&E.SiChipDCOMax, R.SiChipDCOMax);
+				EepromWrite(&R.SiChipDCOMax, sizeof(R.SiChipDCOMax));
 			}
 		}
+		ImageCacheFlush();						// Dividers of the old grade / DCO
+		HopRecalc();
 		usbMsgPtr = (uint8_t*)&R.SiChipDCOMin;
         return sizeof(R.SiChipGrade)+sizeof(R.SiChipDCOMin)+sizeof(R.SiChipDCOMax)+sizeof(R.Si570RFREQIndex);
 
@@ -468,8 +615,8 @@ usbFunctionSetup(uchar data[8])
 	SWITCH_CASE(CMD_SET_RX_BAND_FILTER)			// Set the Filters for band 0..3
 		uint8_t band = rq->wIndex.bytes[0] & (MAX_RX_BAND-1);	// 0..3 only
 		uint8_t filter = rq->wValue.bytes[0];
-		eeprom_write_byte(&E.Band2Filter[band], filter);
 		R.Band2Filter[band] = filter;
+		EepromWrite(&R.Band2Filter[band], sizeof(R.Band2Filter[0]));
 		usbMsgPtr = (uint8_t*)R.Band2Filter;	// Length from 
         return sizeof(R.Band2Filter);
 
@@ -507,7 +654,7 @@ usbFunctionSetup(uchar data[8])
 		replyBuf[0].b0 = (_BV(IO_P2) | _BV(BIT_SDA));	// CW Key 1 (PB4) & 2 (PB1 + i2c SDA)
 		if (!(R.ConfigFlags & CONFIG_ABPF))
 		{
-			if (usbRequest == CMD_SET_PTT)
+			if (usbRequest == CMD_SET_PTT && !KEYER_PTT)
 			{
 			    if (rq->wValue.bytes[0] == 0)
 					bit_0(IO_PORT, IO_P1);
@@ -520,11 +667,50 @@ usbFunctionSetup(uchar data[8])
 		return sizeof(uint8_t);
 #endif
 
+#if INCLUDE_EEPROM_CACHE
+	SWITCH_CASE(CMD_EEPROM_COMMIT)				// Write the changed settings to the eeprom
+		if (rq->wValue.bytes[0] != 0)			// Value zero only returns the count
+			EepromCommit();						// The main loop writes the bytes
+		replyBuf[0].b0 = EepromDirtyCount();	// Bytes still to write
+		return sizeof(uint8_t);
+#endif
+
+	SWITCH_CASE(CMD_GET_EEPROM_CRC)				// Eeprom version, CRC and startup state
+		return EepromStatus((uint8_t*)replyBuf);
+
+#if INCLUDE_CMD_LIST
+	SWITCH_CASE(CMD_SET_LIST)					// Command list of wLength bytes
+		CmdListStart(rq->wLength.word);
+		return USB_NO_MSG;						// use usbFunctionWrite to transfer data
+
+	SWITCH_CASE(CMD_GET_LIST)					// Replies of the last command list
+		return CmdListGetReply();
+#endif
+
+#if INCLUDE_KEYER
+	SWITCH_CASE(CMD_SET_KEYER)					// Keyer mode & WPM in wValue, weight in wIndex
+		R.KeyerMode   = rq->wValue.bytes[0];
+		R.KeyerWpm    = rq->wValue.bytes[1];
+		R.KeyerWeight = rq->wIndex.bytes[0];
+		KeyerInit();							// Check the values and use it
+		EepromWrite(&R.KeyerMode, 3 * sizeof(uint8_t));
+		usbMsgPtr = (uint8_t*)&R.KeyerMode;
+		return 3 * sizeof(uint8_t);
+
+	SWITCH_CASE(CMD_GET_KEYER)					// Keyer mode, WPM and weight
+		usbMsgPtr = (uint8_t*)&R.KeyerMode;
+		return 3 * sizeof(uint8_t);
+#endif
+
+
 	SWITCH_CASE(CMD_CONFIG)						// Enable / disable the config bits
 		R.ConfigFlags |= rq->wValue.bytes[0];
 		R.ConfigFlags &= ~ rq->wIndex.bytes[0];
 		replyBuf[0].b0 = R.ConfigFlags;
-		eeprom_write_byte(&E.ConfigFlags, R.ConfigFlags);
+		EepromWrite(&R.ConfigFlags, sizeof(R.ConfigFlags));
+#if INCLUDE_KEYER
+		KeyerInit();							// Keyer not used with the ABPF
+#endif
         return sizeof(uint8_t);
 
 
@@ -534,6 +720,9 @@ usbFunctionSetup(uchar data[8])
 }
 
 
+// The host build (UsbAvrSim.c) has only the USB functions above.
+#if defined(__AVR__)
+
 // This function is neded, otherwise the USB device is not
 // recognized after a reboot.
 // The watchdog will need to be reset (<16ms). Fast (div 2K) prescaler after watchdog reset!
@@ -558,11 +747,11 @@ int __attribute__((naked))
 main(void)
 {
 
-	// Check if eeprom is initialized, use only the field ChipCrtlData.
-	if (eeprom_read_byte(&E.ChipCrtlData) == 0xFF)
-		eeprom_write_block(&R, &E, sizeof(E));	// Initialize eeprom to "factory defaults".
-	else
-		eeprom_read_block(&R, &E, sizeof(E));	// Load the persistend data from eeprom.
+#if defined(DEVICE_AUTO)
+	DeviceProbe();								// Si570 or Si549, the driver and chip defaults
+#endif
+
+	EepromLoad();								// Load R from eeprom, or the defaults when not valid
 
 	if(R.RC_OSCCAL != 0xFF)
 		OSCCAL = R.RC_OSCCAL;
@@ -583,39 +772,71 @@ main(void)
 	wdt_enable(WDTO_250MS);						// Watchdog 250ms
 
 #if INCLUDE_INTERRUPT							// Include the usb interrupt code
-	intrBufIO.x.io.data = IO_PIN;
-	intrBufFreq.x.freq.data = R.Freq;
+	EventInit();
 #endif
 
 
 	usbInit();									// Init the USB used ports
 
+#if INCLUDE_TIMER
+	TimerInit();								// Millisecond ticks
+#endif
+
+#if INCLUDE_PROFILE
+	ProfileReset();
+#endif
+
+#if INCLUDE_KEYER
+	KeyerInit();								// CW keyer on the pin change interrupt
+#endif
+
+#if INCLUDE_ENCODER
+	EncoderInit();								// Rotary encoder on the pin change interrupt
+#endif
+
 	sei();										// Enable interupts
 
 	while(true)
 	{
 	    wdt_reset();
+
+#if INCLUDE_PROFILE
+		ProfileLoop();							// Main loop period
+#endif
+
 	    usbPoll();								// Run the complete USB stack
 
+#if INCLUDE_I2C_QUEUE
+		I2CQueuePoll();							// Send the next I2C byte to the device
+#endif
+
+#if INCLUDE_SWEEP
+		SweepPoll();							// Next sweep frequency
+#endif
+
+#if INCLUDE_EEPROM_CACHE
+		EepromPoll();							// Write one changed byte to the eeprom
+#endif
+
+#if INCLUDE_TEMP_COMP
+		TempCompPoll();							// Xtal temperature correction
+#endif
+
+#if INCLUDE_ENCODER
+		EncoderPoll();							// Tune with the rotary encoder
+#endif
+
+#if INCLUDE_HOP
+		HopPoll();								// Write the registers of the next hop
+#endif
+
 		DeviceOnline();							// Check chip is online and still not initialized.
 	
 #if INCLUDE_INTERRUPT							// Include the usb interrupt code
-		if ( (R.ConfigFlags & CONFIG_INTERRUPT)	// Only if need the interrupts
-		&&   usbInterruptIsReady() )			// Only if previous data was sent
-		{
-			uint8_t io = IO_PIN;
-			if ((intrBufIO.x.io.data ^ io) & R.IntrMaskIo)
-			{
-				intrBufIO.x.io.data = io;
-				usbSetInterrupt((void*)&intrBufIO, 2);
-			}
-			else if (intrBufFreq.x.freq.data != R.Freq)
-			{
-				intrBufFreq.x.freq.data = R.Freq;
-				usbSetInterrupt((void*)&intrBufFreq, 5);
-			}
-		}
+		EventPoll();							// Check the changes and send the events
 #endif
 
 	}
 }
+
+#endif
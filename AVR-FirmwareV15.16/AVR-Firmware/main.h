@@ -25,29 +25,76 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#if defined(__AVR__)
 #include <avr/io.h>
 #include <avr/wdt.h>
 #include <avr/eeprom.h>
 #include <avr/interrupt.h>
 #include <avr/pgmspace.h>
 #include <util/delay.h>
-#if 1
 #include "usbavrcmd.h"
 #include "usbconfig.h"
 #include "usbdrv.h"
+#else
+#include "HostAvr.h"							// Host build of the frequency calculations
+#include "usbavrcmd.h"
 #endif
 
 #define	VERSION_MAJOR	15
-#define	VERSION_MINOR	16
+#define	VERSION_MINOR	17
 
 // Switch's to set the code needed
 #define	INCLUDE_NOT_USED		1				// Compatibility old firmware, I/O functions
 #define INCLUDE_TEMP			1				// Include the temperature code
-#define INCLUDE_INTERRUPT		0				// Include the usb interrupt code
+#define INCLUDE_INTERRUPT		1				// Include the usb interrupt code
+#define INCLUDE_SI570_DIV_TABLE	1				// Si570 dividers from a flash table (Si570DivTable.h)
+#define INCLUDE_I2C_QUEUE		1				// Si5xx register writes queued, send by the main loop
+#define INCLUDE_SWEEP			1				// Frequency sweep done by the firmware
+#define INCLUDE_EEPROM_CACHE	1				// Eeprom writes done by the main loop
+#define INCLUDE_EEPROM_RING		1				// Startup and xtal freq in a eeprom ring (needs the cache)
+#define INCLUDE_CMD_LIST		1				// More commands in one USB transfer
+#define INCLUDE_KEYER			1				// CW keyer on the CW key lines, output on PTT
+#define INCLUDE_TEMP_COMP		1				// Xtal temperature compensation (needs INCLUDE_TEMP)
+#define INCLUDE_PROFILE			0				// Profile counters, only for the development
+#if defined (__AVR_ATmega328P__)
+#define INCLUDE_ENCODER			1				// Rotary encoder tuning on PC0 / PC1
+#define INCLUDE_HOP				1				// Frequency hop table, timer switched (Si570 / Si549)
+#define INCLUDE_IMAGE_CACHE		1				// Registers of the last used frequencies (Si570 / Si549)
+#else
+#define INCLUDE_ENCODER			0				// No free I/O lines on the ATtiny
+#define INCLUDE_HOP				0				// Not enough RAM on the ATtiny
+#define INCLUDE_IMAGE_CACHE		0				// Not enough RAM on the ATtiny
+#endif
 
+#define INCLUDE_TIMER			(INCLUDE_SWEEP || INCLUDE_EEPROM_RING || INCLUDE_INTERRUPT || INCLUDE_KEYER || INCLUDE_TEMP_COMP || INCLUDE_ENCODER || INCLUDE_PROFILE || INCLUDE_HOP)	// Timer0 millisecond ticks
+
+#if INCLUDE_EEPROM_RING && !INCLUDE_EEPROM_CACHE
+#error INCLUDE_EEPROM_RING needs INCLUDE_EEPROM_CACHE
+#endif
+
+#if INCLUDE_TEMP_COMP && !INCLUDE_TEMP
+#error INCLUDE_TEMP_COMP needs INCLUDE_TEMP
+#endif
+
+#if !defined(DEVICE_SI549) && !defined(DEVICE_SI570) && !defined(DEVICE_AD9850) && !defined(DEVICE_AUTO)
 #define	DEVICE_SI549						// Code generation for the DPLL Si549 chip
 //#define	DEVICE_SI570							// Code generation for the DPLL Si570 chip
 //#define	DEVICE_AD9850						// Code generation for the DDS AD9850 chip
+//#define	DEVICE_AUTO							// Si570 and Si549 driver, the chip is probed at boot
+#endif
+
+#if defined(DEVICE_AUTO)					// Both drivers, called by the Device vtable
+#define	DEVICE_SI570
+#define	DEVICE_SI549
+#endif
+
+#if defined(DEVICE_AUTO) && defined(DEVICE_AD9850)
+#error DEVICE_AUTO is only for the I2C chips Si570 and Si549
+#endif
+
+#if (INCLUDE_HOP || INCLUDE_IMAGE_CACHE) && defined(DEVICE_AD9850)
+#error INCLUDE_HOP and INCLUDE_IMAGE_CACHE need the Si570 or Si549 register image
+#endif
 
 #if defined (__AVR_ATtiny45__) || defined (__AVR_ATtiny85__)
 
@@ -125,10 +172,35 @@ typedef union {
 // Config flags for the R.ConfigFlags
 #define	CONFIG_ABPF				_BV(0)
 #define	CONFIG_INTERRUPT		_BV(1)
+#define	CONFIG_SWEEP_SYNC		_BV(2)			// Toggle IO_P2 on every sweep step, ATmega328P with the keyer off
+#define	CONFIG_SAVE_FREQ		_BV(3)			// Save the running freq as startup freq
+#define	CONFIG_TEMP_COMP		_BV(4)			// Xtal temperature compensation
 
 // Interrupt commands
 #define	INTR_CMD_IO_CHANGE		1
 #define	INTR_CMD_FREQ_CHANGE	2
+#define	INTR_CMD_I2C_ERROR		3				// V15.17: I2C error state changed
+#define	INTR_CMD_ONLINE			4				// V15.17: Chip on-line state changed
+#define	INTR_CMD_KEY			5				// V15.17: Keyer key down / up
+
+// Keyer modes for the R.KeyerMode
+#define	KEYER_OFF				0
+#define	KEYER_STRAIGHT			1				// CW key 1 is the straight key
+#define	KEYER_IAMBIC_A			2
+#define	KEYER_IAMBIC_B			3				// Iambic with paddle memory
+
+#define	KEYER_WPM_MIN			5
+#define	KEYER_WPM_MAX			60
+#define	KEYER_WPM_DEFAULT		20
+#define	KEYER_WEIGHT_MIN		25
+#define	KEYER_WEIGHT_MAX		75
+#define	KEYER_WEIGHT_DEFAULT	50				// Dit and space the same time
+
+#define	TEMP_COMP_POINTS		4				// Points of the temperature table, power of 2
+
+#define	ENCODER_STEPS			4				// Steps of the encoder table, power of 2
+#define	ENCODER_STEP_DEFAULT	{ 2097, 12583, 50332, 201327 }	// 1, 6, 24 and 96 kHz [11.21]
+#define	ENCODER_STEP_MAX		((uint32_t)(1.0 * _2(21)))	// 1 MHz [11.21]
 
 typedef struct 
 {
@@ -150,6 +222,12 @@ typedef struct
 		uint8_t		ChipCrtlData;				// I2C address, default 0x55 (85 dec)
 		uint32_t	MinimalOutputFreqeuency;	// Minimal chip frequency
 		uint32_t	MaximalOutputFreqeuency;	// Maximal chip frequency
+		uint8_t		KeyerMode;					// KEYER_xxx
+		uint8_t		KeyerWpm;					// Keyer speed [WPM]
+		uint8_t		KeyerWeight;				// Keyer weight, 50 is normal
+		uint16_t	TempCompTemp[TEMP_COMP_POINTS];	// Temperature points, ADC value (CMD_GET_CPU_TEMP)
+		int16_t		TempCompXtal[TEMP_COMP_POINTS];	// Xtal correction at the points [8.24]
+		uint32_t	EncoderStep[ENCODER_STEPS];	// Encoder step, slow to fast turning [11.21]
 } var_t;
 
 extern			var_t	R;						// Variables in RAM
@@ -167,38 +245,122 @@ typedef struct __attribute__((__packed__)) {
 extern			chip_t	ChipInfo;				// Connected VFO chip
 
 #if INCLUDE_INTERRUPT							// Include the usb interrupt code
-typedef struct {
-	uint8_t		cmd;
-	union {
-		struct { uint8_t data; } io;
-		struct { uint32_t data; } freq;
-	} x; 
-} intrBuf_t;
-
-extern	intrBuf_t	intrBufIO;				// Interrupt buffer cmd for IO changed
-extern	intrBuf_t	intrBufFreq;			// Interrupt buffer cmd for Freq changed
+extern	uint32_t	EventFreq;				// Last frequency send by the interrupt
+extern	void		EventInit(void);
+extern	void		EventPoll(void);
+extern	void		EventAdd(uint8_t cmd, uint32_t data);
+#else
+#define	EventAdd(cmd, data)
 #endif
 
 extern	sint16_t	replyBuf[4];			// USB Reply buffer
 extern	uint8_t		intrBuf[8];				// Buffer used for the interrupt data
 
 extern	void		Si_CmdReg(uint8_t reg, uint8_t data);
-extern	uint8_t		Si_ReadRegisters(uint8_t index);
 extern	void		SetFreq(uint32_t freq, uint8_t freq_fine);
+extern	uint32_t	CalcFreqDevice(uint32_t freq, uint8_t* filter);
+extern	void		SetFilter(uint8_t filter);
+#if !defined(DEVICE_AUTO)
+extern	uint8_t		Si_ReadRegisters(uint8_t index);
 extern	void		SetFreqDevice(uint32_t freq, uint8_t );
 extern	void		DeviceInit(void);
 extern	void		DeviceOnline(void);
+#endif
 extern	uint16_t	GetTemperature(void);
 extern	void		CalcFreqFromRegSi570(uint8_t* reg);
 
+enum	{ EEPROM_OK, EEPROM_DEFAULTS, EEPROM_LEGACY, EEPROM_CRC_ERROR };	// Startup state of E
+
+extern	void		EepromLoad(void);
+extern	uint8_t		EepromStatus(uint8_t* reply);
+extern	uint8_t		EepromGetState(void);
+extern	uint8_t		EepromReadByte(const void* r);
+extern	void		EepromWrite(const void* r, uint8_t size);
+extern	void		EepromSetStartup(uint32_t freq);
+extern	uint32_t	EepromGetStartup(void);
+#if INCLUDE_EEPROM_CACHE
+extern	void		EepromPoll(void);
+extern	void		EepromFlush(void);
+extern	void		EepromCommit(void);
+extern	uint8_t		EepromDirtyCount(void);
+#else
+#define	EepromFlush()
+#endif
+
+#if INCLUDE_TIMER
+extern	void		TimerInit(void);
+extern	uint16_t	TimerGetTicks(void);
+#endif
+
+#if INCLUDE_SWEEP
+extern	void		SweepStart(uint32_t start, uint32_t step, uint16_t count, uint16_t dwell);
+extern	void		SweepStop(void);
+extern	void		SweepPoll(void);
+extern	uint8_t		SweepStatus(uint8_t* reply);
+#else
+#define	SweepStop()
+#endif
+
+#if INCLUDE_KEYER
+extern	void		KeyerInit(void);
+extern	void		KeyerTick(void);
+extern	uint8_t		KeyerGetState(uint16_t* tick);
+#define	KEYER_PTT			(R.KeyerMode != KEYER_OFF)	// The keyer drives the PTT
+#else
+#define	KEYER_PTT			false
+#endif
+
+#if INCLUDE_TEMP_COMP
+extern	void		TempCompPoll(void);
+extern	uint32_t	TempCompFreq(uint32_t freq);
+extern	uint8_t		TempCompStatus(uint8_t* reply, uint8_t index);
+#endif
+
+#if INCLUDE_ENCODER
+extern	void		EncoderInit(void);
+extern	void		EncoderPoll(void);
+#endif
+
+#if INCLUDE_PROFILE
+enum { PROFILE_SET_FREQ, PROFILE_SET_FREQ_DEVICE, PROFILE_I2C, PROFILE_EEPROM, PROFILE_LOOP, PROFILE_COUNT };
+extern	uint16_t	TimerGetCounts(void);
+extern	void		ProfileReset(void);
+extern	void		ProfileAdd(uint8_t n, uint16_t start);
+extern	void		ProfileLoop(void);
+extern	uint8_t		ProfileGet(void);
+#define	BENCH_CALLS				64				// Calls of a function in the benchmark, 4 cycles a count
+#if defined(DEVICE_SI570)
+extern	void		Si570Bench(uint16_t* cycles, uint32_t freq, uint32_t step);
+#endif
+#if defined(DEVICE_SI549)
+extern	void		Si549Bench(uint16_t* cycles, uint32_t freq, uint32_t step);
+#endif
+#define	PROFILE_START(t)		uint16_t t = TimerGetCounts()
+#define	PROFILE_STOP(n, t)		ProfileAdd(n, t)
+#else
+#define	PROFILE_START(t)
+#define	PROFILE_STOP(n, t)
+#endif
+
+#if INCLUDE_CMD_LIST
+extern	void		CmdListStart(uint16_t len);
+extern	uint8_t		CmdListWrite(const uint8_t* data, uint8_t len);
+extern	uint8_t		CmdListGetReply(void);
+#endif
+
 
 //-------------------------------------------------------------------------------------------------
-//---- SiLabs SI570
+//---- SiLabs SI570 and SI549, DEVICE_AUTO has the registers of both
 //-------------------------------------------------------------------------------------------------
-#if defined(DEVICE_SI570)
+#if defined(DEVICE_SI570) || defined(DEVICE_SI549)
 
 typedef union {
+#if defined(DEVICE_SI549)
+	uint8_t			bData[11];
+#else
 	uint8_t			bData[6];
+#endif
+#if defined(DEVICE_SI570)
 	struct {								// Si570 (6 bytes)
 		uint8_t		N1_HS_DIV;				// HS_DIV_2_0 << 5 | N1_6_2
 		uint8_t		N1_RFREQ_37_32;			// N1[1:0] RFREQ[37:32]
@@ -207,11 +369,24 @@ typedef union {
 		uint8_t		RFREQ_15_8;				// RFREQ[15:8]
 		uint8_t		RFREQ_7_0;				// RFREQ[7:0]
 	};
+#endif
+#if defined(DEVICE_SI549)
+	struct {		// Si549 (11 bytes)
+		uint8_t		HSDIV_7_0;
+		uint8_t		LSDIV_2_0_HSDIV_10_8;
+		uint8_t		FBDIV_7_0;
+		uint8_t		FBDIV_15_8;
+		uint8_t		FBDIV_23_16;
+		uint8_t		FBDIV_31_24;
+		uint8_t		FBDIV_39_32;
+		uint8_t		FBDIV_42_40;
+		uint8_t		ADPLL_DELTA_M_7_0;
+		uint8_t		ADPLL_DELTA_M_15_8;
+		uint8_t		ADPLL_DELTA_M_23_16;
+	};
+#endif
 } Si_Reg_t;
 
-#define Chip_Grade_Default		CHIP_GRADE_C			// Use rhe grade A chip by default
-#define Chip_Freq_Xtal			0x7248F5C2				// crystal frequency[MHz] [8.24] 114.285MHz
-
 // The divider restrictions for the 3 Si57x speed grades or frequency grades are as follows
 // - Grade A covers 10 to 945 MHz, 970 to 1134 MHz, and 1213 to 1417.5 MHz. Speed grade A
 //   device have no divider restrictions.
@@ -219,69 +394,97 @@ typedef union {
 //   N1*HS_DIV settings: 1*4, 1*5
 // - Grade C covers 10 to 280 MHz. Speed grade C devices disable the output in the following
 //   N1*HS_DIV settings: 1*4, 1*5, 1*6, 1*7, 1*11, 2*4, 2*5, 2*6, 2*7, 2*9, 4*4
-#define	CHIP_GRADE_A			1			// Si570 Grade A device is used. (10 - 1417MHz)
-#define	CHIP_GRADE_B			2			// Si570 Grade B device is used. (10 - 810MHz)
-#define	CHIP_GRADE_C			3			// Si570 Grade C device is used. (10 - 280MHz)
-// Removing the 4*4 is out of the spec of the C grade chip, it may work!
-#define	CHIP_GRADE_D			4			// Si570 Grade C device is used. (10 - 354MHz)
-
-#define CHIP_MinimalOutputFreqeuency		((uint32_t)(  10.0 * _2(21)))
-#define	CHIP_MaximalOutputFreqeuency_A		((uint32_t)(1417.5 * _2(21)))
-#define	CHIP_MaximalOutputFreqeuency_B		((uint32_t)( 810.0 * _2(21)))
-#define	CHIP_MaximalOutputFreqeuency_C		((uint32_t)( 280.0 * _2(21)))
+// The Si549 grades are A 0,25 - 1500 MHz, B 0,25 - 800 MHz and C 0,25 - 325 MHz.
+// The grade D is for the Si570 the grade C without the 4*4 (out of the spec,
+// it may work!), for the Si549 no frequency check is done.
+// The frequency range of the grades is in the DeviceSi570.c / DeviceSi549.c file.
+#define	CHIP_GRADE_A			1			// Si Grade A device is used.
+#define	CHIP_GRADE_B			2			// Si Grade B device is used.
+#define	CHIP_GRADE_C			3			// Si Grade C device is used.
+#define	CHIP_GRADE_D			4			// Si Grade D, see above.
 
+#if defined(DEVICE_SI570)
 // Using register-bank auto (Check 'signature' 07h, C2h, C0h, 00h, 00h, 00h) , 7Index (50ppm, 20ppm), 13Index (7ppm)
 #define	RFREQ_DEFAULT_INDEX		0			// 0 if AUTO index!
 #define	RFREQ_7_INDEX			7
 #define	RFREQ_13_INDEX			13
 #define	RFREQ_INDEX				0x7F
 #define	RFREQ_FREEZE			0x80
+#endif
 
-extern	Si_Reg_t				Si_Reg_Data;	// Registers 7..12 value for the Si570
+extern	Si_Reg_t				Si_Reg_Data;	// Registers 7..12 Si570, 23..31 and 231..233 Si549
 extern	uint8_t					Chip_OffLine;	// Chip off-line
 
-//-------------------------------------------------------------------------------------------------
-//---- SiLabs SI549
-//-------------------------------------------------------------------------------------------------
-#elif defined(DEVICE_SI549)
+#if defined(DEVICE_SI549)
+#define	SI549_PAGE_UNKNOWN		0xFF			// Page register not written yet
+extern	uint8_t					Si549Page;		// Last written Si549 page register 255
+#endif
 
-typedef union {
-	uint8_t			bData[11];
-	struct {		// Si549 (11 bytes)
-		uint8_t		HSDIV_7_0;
-		uint8_t		LSDIV_2_0_HSDIV_10_8;
-		uint8_t		FBDIV_7_0;
-		uint8_t		FBDIV_15_8;
-		uint8_t		FBDIV_23_16;
-		uint8_t		FBDIV_31_24;
-		uint8_t		FBDIV_39_32;
-		uint8_t		FBDIV_42_40;
-		uint8_t		ADPLL_DELTA_M_7_0;
-		uint8_t		ADPLL_DELTA_M_15_8;
-		uint8_t		ADPLL_DELTA_M_23_16;
+typedef struct {								// Registers and state of a large change
+	Si_Reg_t	reg;							// Registers 7..12 / 23..31, ADPLL_DELTA_M zero
+	uint32_t	center;							// Smooth tune center frequency
+	union {
+#if defined(DEVICE_SI570)
+		struct {
+			uint16_t	N;						// Total division (N1 * HS_DIV)
+			uint8_t		N1;						// The slow divider
+			uint8_t		HS_DIV;					// The high speed divider
+		};
+#endif
+#if defined(DEVICE_SI549)
+		struct {
+			uint32_t	recip;					// Reciprocal of the center
+			uint8_t		shift;					// Shift of the reciprocal
+		};
+#endif
 	};
-} Si_Reg_t;
-
-#define	CHIP_GRADE_A			1			// Si Grade A device is used. (0,25 - 1500 MHz)
-#define	CHIP_GRADE_B			2			// Si Grade B device is used. (0,25 - 800  MHz)
-#define	CHIP_GRADE_C			3			// Si Grade C device is used. (0,25 - 325  MHz)
-#define	CHIP_GRADE_D			4			// Si Grade D, not e real chip grade only no frequency check done.
-
-#define CHIP_MinimalOutputFreqeuency		((uint32_t)(   0.2 * _2(21)))
-#define	CHIP_MaximalOutputFreqeuency_A		((uint32_t)(1500.0 * _2(21)))
-#define	CHIP_MaximalOutputFreqeuency_B		((uint32_t)( 800.0 * _2(21)))
-#define	CHIP_MaximalOutputFreqeuency_C		((uint32_t)( 325.0 * _2(21)))
-
-#define Chip_Grade_Default		CHIP_GRADE_A			// Use rhe grade A chip by default
-#define Chip_Freq_Xtal			0x98999999				// Si549 Chip crystal frequency, 152.6MHz * [8.24](32)
+} image_t;
+
+#if defined(DEVICE_AUTO)
+typedef struct {								// Driver of a chip, the functions of the device file
+	void		(*SetFreq)(uint32_t freq, uint8_t index);
+	void		(*Init)(void);
+	void		(*Online)(void);
+	uint8_t		(*ReadRegisters)(uint8_t index);
+	uint8_t		(*CalcImage)(uint32_t freq, image_t* image);
+	void		(*SetImage)(const image_t* image);
+	uint8_t		(*SmoothTune)(uint32_t freq);
+	chip_t		chip;							// Chip ID, default grade and factory xtal
+	uint8_t		ConfigFlags;					// Default config flags
+	uint32_t	Freq;							// Default startup frequency [11.21]
+	sint16_t	Band2CrossOver[MAX_RX_BAND];	// Default filter cross over
+	uint16_t	SmoothTunePPM;					// Default smooth tune
+	uint16_t	DCOMin;							// Default min VCO frequency [MHz]
+	uint16_t	DCOMax;							// Default max VCO frequency [MHz]
+} device_t;
+
+extern	const device_t	DeviceSi570 PROGMEM;
+extern	const device_t	DeviceSi549 PROGMEM;
+extern	device_t		Device;					// Driver of the probed chip
+extern	void			DeviceProbe(void);
+extern	void			DeviceAutoOnline(void);
+
+#define	SetFreqDevice			Device.SetFreq
+#define	DeviceInit				Device.Init
+#define	DeviceOnline			DeviceAutoOnline
+#define	Si_ReadRegisters		Device.ReadRegisters
+#define	DeviceCalcImage			Device.CalcImage
+#define	DeviceSetImage			Device.SetImage
+#define	DeviceSmoothTune		Device.SmoothTune
+#define	SI_REG_SIZE				(Device.chip.chipID == CHIP_SI570 ? 6 : 11)	// Registers of the probed chip
+#else
+extern	uint8_t		DeviceCalcImage(uint32_t freq, image_t* image);
+extern	void		DeviceSetImage(const image_t* image);
+extern	uint8_t		DeviceSmoothTune(uint32_t freq);
+#define	SI_REG_SIZE				sizeof(Si_Reg_t)
+#endif
 
-extern	Si_Reg_t				Si_Reg_Data;			// Registers 7..12 value for the Si570
-extern	uint8_t					Chip_OffLine;			// Chip off-line
+#endif
 
 //-------------------------------------------------------------------------------------------------
 //---- Analog Devices AD9850
 //-------------------------------------------------------------------------------------------------
-#elif defined(DEVICE_AD9850)							// Code generation for the DDS AD9850 chip
+#if defined(DEVICE_AD9850)								// Code generation for the DDS AD9850 chip
 
 #define	DEVICE_XTAL		( 100.0 * _2(24) )				// Clock of the DDS chip [8.24]
 #define	DEVICE_I2C		( 0x00 )						// Used for DDS control / phase word
@@ -289,23 +492,60 @@ extern	uint8_t					Chip_OffLine;			// Chip off-line
 #define	DDS_DATA		PB1
 #define	DDS_W_CLK		PB3
 #define	DDS_FQ_UD		PB4
+#define	SI_REG_SIZE		sizeof(Si_Reg_t)
 
-#else
+#endif
+
+#if !defined(DEVICE_SI570) && !defined(DEVICE_SI549) && !defined(DEVICE_AD9850)
 #error Define one frequency device.
+#endif
+
+#if INCLUDE_HOP
+extern	uint8_t		HopSetEntry(uint8_t index, uint32_t freq, uint16_t dwell);
+extern	void		HopStart(uint8_t count, uint8_t loops);
+extern	uint8_t		HopStatus(uint8_t* reply);
+extern	void		HopTick(void);
+extern	void		HopPoll(void);
+extern	void		HopRecalc(void);
+#define	HopStop()			HopStart(0, 0)
+#else
+#define	HopStop()
+#define	HopRecalc()
+#endif
+
+#if INCLUDE_IMAGE_CACHE
+extern	uint8_t		ImageCacheCalc(uint32_t freq, image_t* image);
+extern	void		ImageCacheFlush(void);
+extern	uint8_t		ImageCacheStatus(uint8_t* reply, uint8_t clear);
+#else
+#define	ImageCacheFlush()
 #endif
 
 //-------------------------------------------------------------------------------------------------
 
-//#define	I2C_KBITRATE	400.0			// I2C Bus speed in Kbs
-#define	I2C_KBITRATE	200.0				// 400 was to high?!?
+#define	I2C_KBITRATE	400.0				// I2C Bus speed in Kbs (Fast-mode)
 
 extern	uint8_t		I2CErrors;
+#if INCLUDE_KEYER
+extern	volatile uint8_t	I2CActive;
+#endif
 extern	void		I2CSendStart(void);
 extern	void		I2CSendStop(void);
 extern	void		I2CSendByte(uint8_t b);
 extern	void 		I2CSend0(void);
 extern	void 		I2CSend1(void);
 extern	uint8_t		I2CReceiveByte(void);
+extern	void		I2CWriteRegs(uint8_t reg, const uint8_t* data, uint8_t len);
+
+#if INCLUDE_I2C_QUEUE
+extern	uint8_t		I2CQueueCount;
+extern	void		I2CQueuePoll(void);
+extern	void		I2CQueueFlush(void);
+#define	I2C_WRITE_OK		true				// The queue drops the next writes after a error
+#else
+#define	I2CQueueFlush()
+#define	I2C_WRITE_OK		(I2CErrors == 0)
+#endif
 
 #if 0
 #   define SWITCH_START(cmd)       switch(cmd){{
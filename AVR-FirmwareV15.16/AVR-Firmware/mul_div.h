@@ -14,6 +14,8 @@
 //** Description..: Calculations for 48bits multiply and divide
 //**
 //** History......: 2018/04/20: PE0FKO.
+//**                Portable C version for the host build, same results as
+//**                the AVR assembler code.
 //**
 //**************************************************************************
  
@@ -21,6 +23,8 @@
 #ifndef MUL_DIV_H_
 #define MUL_DIV_H_
 
+#if defined(__AVR__)
+
 inline uint64_t
 umul_48_32_16(uint32_t A, uint16_t B)
 {
@@ -132,6 +136,40 @@ udiv_48_48_32_R(uint64_t A, uint32_t B, uint8_t R)
 	return X.ll;
 }
 
+#else
+
+//	Product(48bits) = A(32bits) * B(16bits)
+static inline uint64_t
+umul_48_32_16(uint32_t A, uint16_t B)
+{
+	return (uint64_t)A * B;
+}
+
+//	Quotient(48bits)  = (Dividend(48bits) << R) / Divisor(32bits)
+//	The same shift and subtract loop as the AVR code, (A << R) can be 83 bits.
+static inline uint64_t
+udiv_48_48_32_R(uint64_t A, uint32_t B, uint8_t R)
+{
+	uint64_t	X = A & 0x0000FFFFFFFFFFFFULL;
+	uint32_t	remainder = 0;
+	uint8_t		carry;
+
+	R += 48;
+
+	do {
+		carry = remainder >> 31;
+		remainder = (remainder << 1) | (uint32_t)((X >> 47) & 1);
+		X = (X << 1) & 0x0000FFFFFFFFFFFFULL;
+		if (carry || remainder >= B)
+		{
+			remainder -= B;
+			X |= 1;
+		}
+	} while (--R);
+
+	return X | (A & 0xFFFF000000000000ULL);
+}
 
+#endif
 
 #endif /* MUL_DIV_H_ */
\ No newline at end of file
@@ -78,6 +78,16 @@
 
 // Si549 extension
 #define	CMD_GET_CHIP_INFO		0x45	// V15.16
+#define	CMD_GET_I2C_STATUS		0x46	// V15.17: Queued I2C writes and error status
+#define	CMD_SET_SWEEP			0x47	// V15.17: Start / stop a frequency sweep
+#define	CMD_GET_SWEEP			0x48	// V15.17: Sweep steps to go and frequency
+#define	CMD_EEPROM_COMMIT		0x49	// V15.17: Write the changed settings now to the eeprom
+#define	CMD_GET_EEPROM_CRC		0x4A	// V15.17: Eeprom version, CRC and startup state
+#define	CMD_SET_LIST			0x4B	// V15.17: Run a list of commands
+#define	CMD_GET_LIST			0x4C	// V15.17: Replies of the command list
+#define	CMD_SET_KEYER			0x4D	// V15.17: Set the CW keyer mode, WPM and weight
+#define	CMD_GET_KEYER			0x4E	// V15.17: Get the CW keyer mode, WPM and weight
+#define	CMD_SET_TEMP_COMP		0x4F	// V15.17: Set a xtal temperature compensation point
 
 
 
@@ -86,6 +96,17 @@
 //								0x52	// V2.0: 
 //								0x53	// V2.0: 
 //								0x54	// V2.0: 
+//								0x55	// CMD_CONFIG
+#define	CMD_GET_TEMP_COMP		0x56	// V15.17: Xtal temperature compensation point and status
+#define	CMD_SET_ENCODER			0x57	// V15.17: Set a rotary encoder step
+#define	CMD_GET_ENCODER			0x58	// V15.17: Get a rotary encoder step
+#define	CMD_GET_PROFILE			0x59	// V15.17: Profile counters (INCLUDE_PROFILE)
+#define	CMD_RESET_PROFILE		0x5A	// V15.17: Clear the profile counters (INCLUDE_PROFILE)
+#define	CMD_SET_HOP				0x5B	// V15.17: Set a frequency hop table entry
+#define	CMD_START_HOP			0x5C	// V15.17: Start / stop the frequency hops
+#define	CMD_GET_HOP				0x5D	// V15.17: Frequency hop status
+#define	CMD_GET_IMAGE_CACHE		0x5E	// V15.17: Register image cache hits and misses
+#define	CMD_GET_BENCH			0x5F	// V15.17: CPU cycles of the frequency math (INCLUDE_PROFILE)
 
 // Mobo command's
 #define	CMD_GET_FW_FEATURE		0x60	// Firmware Feature select